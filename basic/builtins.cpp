@@ -0,0 +1,162 @@
+//
+//  builtins.cpp
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+
+#include "builtins.h"
+#include "parser.h"
+
+// Missing trailing arguments read as 0 / "" (only optional ones can be missing
+// once check_builtin_arity has passed).
+static double argN(const Value* args, size_t argc, size_t i) {
+    return i < argc ? args[i].asNumber() : 0.0;
+}
+
+// Borrowed from the argument (no copy); numeric arguments format into a temporary.
+static const std::string& argS(const Value* args, size_t argc, size_t i) {
+    static const std::string noArg;
+    return i < argc ? args[i].asString() : noArg;
+}
+
+static Value fn_SIN(Env&, const Value* a, size_t n) { return Value(std::sin(argN(a, n, 0))); }
+static Value fn_COS(Env&, const Value* a, size_t n) { return Value(std::cos(argN(a, n, 0))); }
+static Value fn_TAN(Env&, const Value* a, size_t n) { return Value(std::tan(argN(a, n, 0))); }
+static Value fn_ATN(Env&, const Value* a, size_t n) { return Value(std::atan(argN(a, n, 0))); }
+static Value fn_LOG(Env&, const Value* a, size_t n) { return Value(std::log(argN(a, n, 0))); }
+static Value fn_EXP(Env&, const Value* a, size_t n) { return Value(std::exp(argN(a, n, 0))); }
+static Value fn_SQR(Env&, const Value* a, size_t n) { return Value(std::sqrt(argN(a, n, 0))); }
+static Value fn_ABS(Env&, const Value* a, size_t n) { return Value(std::fabs(argN(a, n, 0))); }
+static Value fn_INT(Env&, const Value* a, size_t n) { return Value(std::floor(argN(a, n, 0))); }
+
+static Value fn_SGN(Env&, const Value* a, size_t n) {
+    double x = argN(a, n, 0);
+    int16_t r = (x > 0) ? static_cast<int16_t>(1) : ((x < 0) ? static_cast<int16_t>(-1) : static_cast<int16_t>(0));
+    return Value(r);
+}
+
+static Value fn_RND(Env& env, const Value* a, size_t n) {
+    // GW-BASIC-ish behavior:
+    //   RND()      -> next random number
+    //   RND(x>0)   -> next random number (does NOT reseed)
+    //   RND(0)     -> repeat last random number (or generate if none)
+    //   RND(x<0)   -> reseed using abs(x) and return next random number
+
+    double x = n == 0 ? 1.0 : argN(a, n, 0);
+
+    if (x == 0.0) {
+        if (!env.hasLastRnd) {
+            double r = static_cast<double>(std::rand()) / (static_cast<double>(RAND_MAX) + 1.0);
+            env.lastRnd = r;
+            env.hasLastRnd = true;
+        }
+        return Value(env.lastRnd);
+    }
+
+    if (x < 0.0) {
+        long long sx = static_cast<long long>(x);
+        unsigned seed = static_cast<unsigned>(std::llabs(sx));
+        std::srand(seed);
+        env.hasLastRnd = false;
+    }
+
+    // Generate next value
+    double r = static_cast<double>(std::rand()) / (static_cast<double>(RAND_MAX) + 1.0);
+    env.lastRnd = r;
+    env.hasLastRnd = true;
+    return Value(r);
+}
+
+static Value fn_TIME(Env&, const Value*, size_t) {
+    // TIME(): return current time in seconds since midnight (local time).
+    // This is a numeric analogue to TIME$ in classic BASIC dialects.
+    std::time_t t = std::time(nullptr);
+    std::tm lt{};
+#if defined(_WIN32)
+    localtime_s(&lt, &t);
+#else
+    std::tm* p = std::localtime(&t);
+    if (p) lt = *p;
+#endif
+    double secs = static_cast<double>(lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
+    return Value(secs);
+}
+
+static Value fn_FRE(Env& env, const Value* a, size_t n) {
+    // FRE(x): free bytes in the string heap. FRE("") also drops recycled buffers.
+    if (n > 0 && a[0].isString()) env.strings.trim();
+    return Value(env.strings.freeBytes());
+}
+
+static Value fn_VAL(Env&, const Value* a, size_t n) { return Value(Value(argS(a, n, 0)).asNumber()); }
+static Value fn_STR(Env&, const Value* a, size_t n) { return Value(Value(argN(a, n, 0)).asString()); }
+static Value fn_LEN(Env&, const Value* a, size_t n) { return Value(static_cast<double>(argS(a, n, 0).size())); }
+
+static Value fn_LEFT(Env&, const Value* a, size_t n) {
+    const std::string& s = argS(a, n, 0);
+    int k = static_cast<int>(argN(a, n, 1));
+    if (k < 0) k = 0;
+    if (static_cast<size_t>(k) > s.size()) k = static_cast<int>(s.size());
+    return Value(s.substr(0, static_cast<size_t>(k)));
+}
+
+static Value fn_RIGHT(Env&, const Value* a, size_t n) {
+    const std::string& s = argS(a, n, 0);
+    int k = static_cast<int>(argN(a, n, 1));
+    if (k < 0) k = 0;
+    if (static_cast<size_t>(k) > s.size()) k = static_cast<int>(s.size());
+    return Value(s.substr(s.size() - static_cast<size_t>(k)));
+}
+
+static Value fn_MID(Env&, const Value* a, size_t n) {
+    const std::string& s = argS(a, n, 0);
+    int start = static_cast<int>(argN(a, n, 1));
+    int len = (n >= 3) ? static_cast<int>(argN(a, n, 2)) : static_cast<int>(s.size());
+    if (start < 1) start = 1; // BASIC is 1-based
+    size_t idx = static_cast<size_t>(start - 1);
+    if (idx >= s.size()) return Value(std::string(""));
+    if (len < 0) len = 0;
+    size_t k = std::min(static_cast<size_t>(len), s.size() - idx);
+    return Value(s.substr(idx, k));
+}
+
+static Value fn_CHR(Env&, const Value* a, size_t n) {
+    return Value(std::string(1, static_cast<char>(static_cast<int>(argN(a, n, 0)) & 0xFF)));
+}
+
+static Value fn_ASC(Env&, const Value* a, size_t n) {
+    const std::string& s = argS(a, n, 0);
+    if (s.empty()) return Value(0.0);
+    return Value(static_cast<double>(static_cast<unsigned char>(s[0])));
+}
+
+// TAB(n): move cursor to 1-based column n; return "" so PRINT doesn't output 0.
+// This is intentionally a side-effecting function for PRINT usage.
+static Value fn_TAB(Env& env, const Value* a, size_t n) {
+    basic_print_tab_to_column1(env, static_cast<int>(argN(a, n, 0)));
+    return Value(std::string(""));
+}
+
+const BuiltinInfo kBuiltins[static_cast<size_t>(Builtin::Count)] = {
+    {"", 0, 0, false, nullptr},
+    {"SIN", 1, 1, true, fn_SIN}, {"COS", 1, 1, true, fn_COS}, {"TAN", 1, 1, true, fn_TAN},
+    {"ATN", 1, 1, true, fn_ATN}, {"LOG", 1, 1, true, fn_LOG}, {"EXP", 1, 1, true, fn_EXP},
+    {"SQR", 1, 1, true, fn_SQR}, {"ABS", 1, 1, true, fn_ABS}, {"INT", 1, 1, true, fn_INT},
+    {"SGN", 1, 1, true, fn_SGN},
+    {"RND", 0, 1, false, fn_RND}, {"TIME", 0, 0, false, fn_TIME}, {"FRE", 0, 1, false, fn_FRE},
+    {"VAL", 1, 1, true, fn_VAL}, {"STR$", 1, 1, true, fn_STR}, {"LEN", 1, 1, true, fn_LEN},
+    {"LEFT$", 2, 2, true, fn_LEFT}, {"RIGHT$", 2, 2, true, fn_RIGHT}, {"MID$", 2, 3, true, fn_MID},
+    {"CHR$", 1, 1, true, fn_CHR}, {"ASC", 1, 1, true, fn_ASC}, {"TAB", 1, 1, false, fn_TAB},
+};
+
+uint8_t builtin_id(std::string_view name) {
+    for (size_t id = 1; id < static_cast<size_t>(Builtin::Count); ++id) {
+        std::string_view w = kBuiltins[id].name;
+        if (w.size() != name.size()) continue;
+        size_t i = 0;
+        while (i < w.size() && keyword_upper(name[i]) == w[i]) ++i;
+        if (i == w.size()) return static_cast<uint8_t>(id);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+//
+//  builtins.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include "env.h"
+
+// Builtin functions are resolved to an ID once (Token::fn for stored lines, the
+// Compiler for bytecode) and called through a table. Arguments are passed as a
+// contiguous run of Values: a fixed array on the Parser's C++ stack, or the top of
+// the VM stack, so a call allocates nothing.
+
+enum class Builtin : uint8_t {
+    None,
+    SIN, COS, TAN, ATN, LOG, EXP, SQR, ABS, INT, SGN,
+    RND, TIME, FRE, VAL, STR, LEN, LEFT, RIGHT, MID, CHR, ASC, TAB,
+    Count
+};
+
+inline constexpr size_t kMaxBuiltinArgs = 3;
+
+using BuiltinFn = Value (*)(Env& env, const Value* args, size_t argc);
+
+struct BuiltinInfo {
+    std::string_view name; // upper-case spelling
+    uint8_t minArgs;
+    uint8_t maxArgs;
+    bool pure; // no side effects and no state: the compiler may fold constant calls
+    BuiltinFn fn;
+};
+
+extern const BuiltinInfo kBuiltins[static_cast<size_t>(Builtin::Count)];
+
+// Builtin ID for an identifier spelled in any case, or 0 if it is not a builtin.
+uint8_t builtin_id(std::string_view name);
+
+inline void check_builtin_arity(uint8_t id, size_t argc) {
+    const BuiltinInfo& b = kBuiltins[id];
+    if (argc < b.minArgs || argc > b.maxArgs) throw RuntimeError("Illegal function call");
+}
+
+inline Value call_builtin(Env& env, uint8_t id, const Value* args, size_t argc) {
+    return kBuiltins[id].fn(env, args, argc);
+}
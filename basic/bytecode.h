@@ -0,0 +1,251 @@
+//
+//  bytecode.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include "token.h"
+#include "env.h"
+#include "lexer.h"
+
+// Bytecode engine: the whole program is compiled into one flat instruction array
+// with resolved jump targets, then run by a stack VM. The Parser tree-walker stays
+// available (ENGINE TREE, DEBUG) and is the reference for every semantic below.
+
+enum class Op : uint8_t {
+    Line,        // a = line number; Ctrl+C / ON INTERVAL safe point
+    PushConst,   // a = const index
+    LoadVar,     // a = variable slot
+    StoreVar,    // a = variable slot                [value]
+    StoreIntOp,  // a = int16 variable slot, b = TokenKind, flag = bit0/bit1 lhs/rhs is a
+                 //     whole literal pushed as int16  [lhs rhs]   V = lhs op rhs
+    AddVarConst, // a = variable slot, b = numeric const index, flag = bit0 subtract,
+                 //     bit1 the const is a whole int16        V = V + k / V = V - k
+    AppendVar,   // a = variable slot, b = count     [piece...]  S$ = S$ + piece...
+    LoadElem,    // a = name index                   [index]
+    StoreElem,   // a = name index                   [index value]
+    BinOp,       // a = TokenKind of the operator    [lhs rhs]
+    BinI,        // a = TokenKind; operands expected int16      [lhs rhs]
+    BinN,        // a = TokenKind; operands expected numeric, not both int16  [lhs rhs]
+    Neg,
+    Not,
+    Call,        // a = builtin ID, b = argc         [args...]
+    Pop,
+    Print,       //                                  [value]
+    PrintLine,   // Print, then a newline             [value]
+    PrintTab,    // advance to the next PRINT zone
+    PrintChar,   // a = character
+    Jump,        // a = target pc
+    JumpIfFalse, // a = target pc                    [cond]
+    IfVarConst,  // a = variable slot, b = const index, flag = comparison TokenKind;
+                 //     true runs the Jump that follows, false skips it
+    Gosub,       // a = target pc
+    Return,
+    ForInit,     // a = variable slot, b = symbol id [start end step]
+    Next,        // a = variable slot or -1, b = symbol id
+    End,
+    Dim,         // a = name index                   [upper bound]
+    Input,       // a = array name index or variable slot, b = prompt const or -1, flag = array  [index]?
+    Read,        // a = array name index or variable slot, flag = array  [index]?
+    Restore,     // a = line (0 = first DATA)
+    Cls,
+    Locate,      // flag = bit0 row, bit1 col, bit2 cursor present  [args...]
+    Color,       // flag = bit0 fg, bit1 bg present                 [args...]
+    Randomize,   // flag = seed present              [seed]?
+    Beep,        // flag = number of ignored args    [args...]
+    OnInterval,  // a = gosub line                   [ticks]
+    IntervalCtl, // flag = 0 ON, 1 OFF, 2 STOP
+    DefInt,      // a = first letter, b = last letter
+    Clear,       // flag = argument present          [arg]?
+    Raise,       // a = const index of message, flag = 1 syntax error, 0 runtime error
+    Halt         // fell off the end of the program
+};
+
+struct Instr {
+    Op op;
+    uint8_t flag = 0;
+    int32_t a = 0;
+    int32_t b = 0;
+};
+
+struct CompiledProgram {
+    std::vector<Instr> code;
+    std::vector<Value> consts;
+    std::vector<std::string> names;          // array names as written
+    std::unordered_map<int, uint32_t> lineStart; // line number -> pc of its Line op
+    std::vector<std::pair<uint32_t, int>> pcLines; // (pc, line) in pc order, one per line slot, then Halt
+    std::vector<std::vector<uint32_t>> stmtStarts; // per line slot: pc of each ':'-separated statement
+
+    int lineForPc(uint32_t pc) const {
+        auto it = std::upper_bound(pcLines.begin(), pcLines.end(), pc,
+                                   [](uint32_t p, const std::pair<uint32_t, int>& e) { return p < e.first; });
+        if (it == pcLines.begin()) return 0;
+        return std::prev(it)->second;
+    }
+    // pc of a Parser position (line slot, statement index), as in ProgramLine::stmtStarts.
+    // Statement 0 is the Line op; one past the last, the next line; slots past the end map to Halt.
+    uint32_t pcForStatement(size_t slot, size_t stmt) const {
+        if (slot >= stmtStarts.size()) return pcLines.back().first;
+        if (stmt == 0) return pcLines[slot].first;
+        const auto& starts = stmtStarts[slot];
+        if (stmt < starts.size()) return starts[stmt];
+        return pcLines[slot + 1].first;
+    }
+    uint32_t lineStartForPc(uint32_t pc) const {
+        auto it = std::upper_bound(pcLines.begin(), pcLines.end(), pc,
+                                   [](uint32_t p, const std::pair<uint32_t, int>& e) { return p < e.first; });
+        if (it == pcLines.begin()) return 0;
+        return std::prev(it)->first;
+    }
+};
+
+// Single-pass compiler over the stored token streams. It mirrors the Parser's
+// grammar exactly, emitting code where the Parser would evaluate. Errors the Parser
+// would only raise when a statement runs are compiled into Raise instructions.
+// Operators and pure builtins whose operands are all constants are folded, and the
+// commonest statement shapes are fused into superinstructions (AddVarConst,
+// IfVarConst, PrintLine).
+struct Compiler {
+    Env& env;
+    CompiledProgram& out;
+
+    Lexer lex{std::string()};
+    Token tok{TokenKind::End, "", 0.0};
+
+    // Static type of an expression as far as the compiler can tell. It only picks
+    // which specialized instruction to emit; those re-check the tags at run time and
+    // fall back to Parser::applyOp, so a wrong guess costs speed, never behaviour.
+    enum class SType : uint8_t { Unknown, Int, Double, String };
+    uint32_t intLetters = 0;      // DEFINT letters in force before any variable is bound
+    uint32_t maybeIntLetters = 0; // letters a later DEFINT may switch to int16
+    struct BinSite {
+        size_t lhs, rhs, op;      // pcs of the operands and the operator
+        SType lhsType, rhsType;
+    } lastBin{0, 0, SIZE_MAX, SType::Unknown, SType::Unknown};
+
+    std::unordered_map<std::string, int32_t> nameIndex;
+    std::vector<std::pair<size_t, int>> lineFixups;    // (instr, target line) for GOTO/GOSUB
+    std::vector<size_t> lineEndFixups;                 // IF-false jumps to the end of the current line
+
+    Compiler(Env& e, CompiledProgram& p) : env(e), out(p) {}
+
+    void compileProgram();
+
+private:
+    void compileLine(int ln, const ProgramLine& line);
+    void compileStatementList();
+    void compileStatement();
+
+    SType expression();
+    SType primary();
+    SType binOpRHS(int exprPrec, SType lhs, size_t lhsStart);
+    SType binary(TokenKind op, SType lhs, SType rhs, size_t lhsStart, size_t rhsStart);
+    int argList();
+    bool fold(Op op, int32_t a, size_t operands);
+    bool fuseIntStore(int32_t slot);
+    bool fuseAddVarConst(int32_t slot);
+    bool fuseIfVarConst();
+
+    void inferDefInt();
+    SType varType(int32_t slot) const;
+    SType constType() const;
+    bool wholeLiteral(size_t begin, size_t end) const;
+    void makeIntLiteral(size_t at);
+
+    void stmt_PRINT();
+    void stmt_LET();
+    void stmt_INPUT();
+    void stmt_IF();
+    void stmt_GOTO(bool isGosub);
+    void stmt_FOR();
+    void stmt_NEXT();
+    void stmt_DIM();
+    void stmt_ON();
+    void stmt_INTERVAL();
+    void stmt_LOCATE();
+    void stmt_COLOR();
+    void stmt_RANDOMIZE();
+    void stmt_BEEP();
+    void stmt_DEFINT();
+    void stmt_CLEAR();
+    void stmt_KEY();
+    void stmt_READ();
+    void stmt_RESTORE();
+
+    void advance() { tok = lex.next(); }
+    void consume(TokenKind k, const char* what) {
+        if (tok.kind != k) throw ParseError(std::string("Expected ") + what);
+        advance();
+    }
+    bool accept(TokenKind k) {
+        if (tok.kind == k) { advance(); return true; }
+        return false;
+    }
+    bool atStatementEnd() const { return tok.kind == TokenKind::End || tok.kind == TokenKind::Colon; }
+
+    size_t emit(Op op, int32_t a = 0, int32_t b = 0, uint8_t flag = 0) {
+        out.code.push_back(Instr{op, flag, a, b});
+        return out.code.size() - 1;
+    }
+    int32_t constant(Value v) {
+        out.consts.push_back(std::move(v));
+        return static_cast<int32_t>(out.consts.size() - 1);
+    }
+    int32_t name(const std::string& n) {
+        auto it = nameIndex.find(n);
+        if (it != nameIndex.end()) return it->second;
+        int32_t id = static_cast<int32_t>(out.names.size());
+        out.names.push_back(n);
+        nameIndex.emplace(n, id);
+        return id;
+    }
+    int32_t varSlotOf(const Token& t) {
+        return static_cast<int32_t>(t.var ? t.var : env.varSlot(std::string(t.text)));
+    }
+    uint32_t symbolOf(const Token& t) {
+        return t.sym ? t.sym : env.internSymbol(upper_ascii(t.text));
+    }
+};
+
+struct Jit;
+
+// Stack VM state. It survives between RUN/CONT so a Break or error can be continued.
+struct VM {
+    struct ForFrame {
+        uint32_t var;  // variable slot
+        uint32_t sym;  // interned upper-cased name, for NEXT matching
+        Env::ForCounter counter;
+        uint32_t resumePc;
+    };
+    struct GosubFrame {
+        uint32_t returnPc;
+        bool isInterval = false;
+        size_t savedDataPtr = 0;
+    };
+
+    enum class Status { Ended, Break, Error };
+
+    std::vector<Value> stack;
+    std::vector<ForFrame> forStack;
+    std::vector<GosubFrame> gosubStack;
+    uint32_t pc = 0;
+    Jit* jit = nullptr; // JIT ON: native code for numeric FOR loops
+
+    void reset() {
+        stack.clear();
+        forStack.clear();
+        gosubStack.clear();
+        pc = 0;
+    }
+
+    // Runs until END/STOP, the end of the program, Ctrl+C or an error (already reported).
+    Status run(Env& env, const CompiledProgram& prog, std::atomic<bool>& breakRequested);
+};
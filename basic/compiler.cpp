@@ -0,0 +1,817 @@
+//
+//  compiler.cpp
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+
+#include "bytecode.h"
+#include "parser.h"
+
+// -------------------- Program / line structure --------------------
+
+void Compiler::compileProgram() {
+    out = CompiledProgram{};
+    nameIndex.clear();
+    lineFixups.clear();
+    inferDefInt();
+
+    for (const Env::LineRecord& rec : env.lines) {
+        compileLine(rec.number, *rec.line);
+    }
+    out.pcLines.push_back({static_cast<uint32_t>(out.code.size()), 0});
+    emit(Op::Halt);
+
+    // Resolve GOTO/GOSUB targets. A missing line is only an error if the jump runs.
+    for (const auto& [at, target] : lineFixups) {
+        auto it = out.lineStart.find(target);
+        if (it != out.lineStart.end()) {
+            out.code[at].a = static_cast<int32_t>(it->second);
+        } else {
+            out.code[at] = Instr{Op::Raise, 0, constant(Value::literal("Undefined line number")), 0};
+        }
+    }
+}
+
+void Compiler::compileLine(int ln, const ProgramLine& line) {
+    uint32_t start = static_cast<uint32_t>(out.code.size());
+    out.lineStart[ln] = start;
+    out.pcLines.push_back({start, ln});
+    out.stmtStarts.emplace_back(1, start);
+    emit(Op::Line, ln);
+
+    lineEndFixups.clear();
+    lex = Lexer(line, 0);
+    try {
+        advance();
+        compileStatementList();
+    } catch (const ParseError& e) {
+        // Only reachable when the very first token of the line fails to lex.
+        emit(Op::Raise, constant(Value::literal(e.what())), 0, 1);
+    }
+
+    int32_t end = static_cast<int32_t>(out.code.size());
+    for (size_t at : lineEndFixups) out.code[at].a = end;
+}
+
+void Compiler::compileStatementList() {
+    while (tok.kind != TokenKind::End) {
+        try {
+            compileStatement();
+        } catch (const ParseError& e) {
+            emit(Op::Raise, constant(Value::literal(e.what())), 0, 1);
+            return;
+        } catch (const RuntimeError& e) {
+            emit(Op::Raise, constant(Value::literal(e.what())), 0, 0);
+            return;
+        }
+        if (tok.kind == TokenKind::Colon) {
+            advance();
+            out.stmtStarts.back().push_back(static_cast<uint32_t>(out.code.size()));
+            continue;
+        }
+        break;
+    }
+}
+
+void Compiler::compileStatement() {
+    if (atStatementEnd()) return;
+
+    switch (tok.kind) {
+        case TokenKind::KW_REM:
+            tok = Token{TokenKind::End, "", 0.0};
+            lex.skipToEnd();
+            return;
+        case TokenKind::KW_ON:        advance(); stmt_ON(); return;
+        case TokenKind::KW_PRINT:     advance(); stmt_PRINT(); return;
+        case TokenKind::KW_INPUT:     advance(); stmt_INPUT(); return;
+        case TokenKind::KW_IF:        advance(); stmt_IF(); return;
+        case TokenKind::KW_GOTO:      advance(); stmt_GOTO(false); return;
+        case TokenKind::KW_GOSUB:     advance(); stmt_GOTO(true); return;
+        case TokenKind::KW_RETURN:    advance(); emit(Op::Return); return;
+        case TokenKind::KW_FOR:       advance(); stmt_FOR(); return;
+        case TokenKind::KW_NEXT:      advance(); stmt_NEXT(); return;
+        case TokenKind::KW_DIM:       advance(); stmt_DIM(); return;
+        case TokenKind::KW_COLOR:     advance(); stmt_COLOR(); return;
+        case TokenKind::KW_BEEP:      advance(); stmt_BEEP(); return;
+        case TokenKind::KW_INTERVAL:  advance(); stmt_INTERVAL(); return;
+        case TokenKind::KW_CLS:       advance(); emit(Op::Cls); return;
+        case TokenKind::KW_LOCATE:    advance(); stmt_LOCATE(); return;
+        case TokenKind::KW_RANDOMIZE: advance(); stmt_RANDOMIZE(); return;
+        case TokenKind::KW_DEFINT:    advance(); stmt_DEFINT(); return;
+        case TokenKind::KW_KEY:       advance(); stmt_KEY(); return;
+        case TokenKind::KW_CLEAR:     advance(); stmt_CLEAR(); return;
+        case TokenKind::KW_END:
+        case TokenKind::KW_STOP:
+            emit(Op::End);
+            tok = Token{TokenKind::End, "", 0.0};
+            lex.skipToEnd();
+            return;
+        case TokenKind::KW_LET:       stmt_LET(); return;
+        case TokenKind::KW_DATA:
+            advance();
+            while (!atStatementEnd()) advance();
+            return;
+        case TokenKind::KW_READ:      advance(); stmt_READ(); return;
+        case TokenKind::KW_RESTORE:   advance(); stmt_RESTORE(); return;
+        default:
+            break;
+    }
+
+    if (tok.kind == TokenKind::Identifier) {
+        stmt_LET();
+        return;
+    }
+
+    expression();
+    emit(Op::Pop);
+}
+
+// -------------------- Static types --------------------
+
+static uint32_t letter_bit(std::string_view name) {
+    char c = static_cast<char>(std::toupper(static_cast<unsigned char>(name.empty() ? ' ' : name[0])));
+    return (c >= 'A' && c <= 'Z') ? (1u << (c - 'A')) : 0;
+}
+
+// Analysis pass: DEFINT statements that open the program run before any variable can
+// be bound, so their letters are int16 for the whole run. Letters named by any other
+// DEFINT depend on execution order and are left unknown.
+void Compiler::inferDefInt() {
+    intLetters = maybeIntLetters = 0;
+    bool leading = true;
+    for (const Env::LineRecord& rec : env.lines) {
+        const std::vector<Token>& t = rec.line->tokens;
+        bool stmtStart = true;
+        for (size_t k = 0; k < t.size(); ++k) {
+            if (stmtStart && t[k].kind != TokenKind::KW_DEFINT) leading = false;
+            stmtStart = (t[k].kind == TokenKind::Colon);
+            if (t[k].kind != TokenKind::KW_DEFINT) continue;
+
+            uint32_t letters = 0;
+            while (k + 1 < t.size() && t[k + 1].kind != TokenKind::Colon && t[k + 1].kind != TokenKind::End) {
+                ++k;
+                if (t[k].kind != TokenKind::Identifier) continue;
+                uint32_t from = letter_bit(t[k].text), to = from;
+                if (k + 2 < t.size() && t[k + 1].kind == TokenKind::Minus && t[k + 2].kind == TokenKind::Identifier) {
+                    to = letter_bit(t[k + 2].text);
+                    k += 2;
+                }
+                if (!from || !to) continue;
+                if (from > to) std::swap(from, to);
+                letters |= (to | (to - 1)) & ~(from - 1);
+            }
+            (leading ? intLetters : maybeIntLetters) |= letters;
+        }
+    }
+    maybeIntLetters &= ~intLetters;
+}
+
+Compiler::SType Compiler::varType(int32_t slot) const {
+    const std::string& n = env.varNames[static_cast<size_t>(slot)];
+    if (n.empty()) return SType::Unknown;
+    if (n.back() == '$') return SType::String;
+    if (n.back() == '%') return SType::Int;
+    uint32_t bit = letter_bit(n);
+    if (intLetters & bit) return SType::Int;
+    if (maybeIntLetters & bit) return SType::Unknown;
+    return SType::Double;
+}
+
+// Type of the constant the last instruction (a PushConst) pushes.
+Compiler::SType Compiler::constType() const {
+    const Value& v = out.consts[static_cast<size_t>(out.code.back().a)];
+    if (v.isString()) return SType::String;
+    return v.isInt() ? SType::Int : SType::Double;
+}
+
+// [begin, end) is a single numeric literal with a whole int16 value.
+bool Compiler::wholeLiteral(size_t begin, size_t end) const {
+    if (end != begin + 1 || out.code[begin].op != Op::PushConst) return false;
+    const Value& v = out.consts[static_cast<size_t>(out.code[begin].a)];
+    if (!v.isDouble()) return false;
+    double d = v.asNumber();
+    return d == std::trunc(d) && d >= -32768.0 && d <= 32767.0;
+}
+
+void Compiler::makeIntLiteral(size_t at) {
+    Value& v = out.consts[static_cast<size_t>(out.code[at].a)];
+    v = Value(static_cast<int16_t>(v.asNumber()));
+}
+
+static bool is_numeric(Compiler::SType t) {
+    return t == Compiler::SType::Int || t == Compiler::SType::Double;
+}
+
+// -------------------- Expressions (same grammar as Parser) --------------------
+
+Compiler::SType Compiler::expression() {
+    size_t start = out.code.size();
+    SType t = primary();
+    return binOpRHS(1, t, start);
+}
+
+Compiler::SType Compiler::binOpRHS(int exprPrec, SType lhs, size_t lhsStart) {
+    while (true) {
+        int tokPrec = Parser::precedence(tok.kind);
+        bool rightAssoc = (tok.kind == TokenKind::Caret);
+        if (tokPrec < exprPrec) return lhs;
+
+        TokenKind op = tok.kind;
+        advance();
+
+        size_t rhsStart = out.code.size();
+        SType rhs = primary();
+
+        int nextPrec = Parser::precedence(tok.kind);
+        if (tokPrec < nextPrec || (tokPrec == nextPrec && rightAssoc)) {
+            rhs = binOpRHS(tokPrec + (rightAssoc ? 0 : 1), rhs, rhsStart);
+        }
+
+        lhs = binary(op, lhs, rhs, lhsStart, rhsStart);
+    }
+}
+
+// Emits `op` with the most specific instruction the operand types allow.
+Compiler::SType Compiler::binary(TokenKind op, SType lhs, SType rhs, size_t lhsStart, size_t rhsStart) {
+    if (fold(Op::BinOp, static_cast<int32_t>(op), 2)) return constType();
+
+    bool compare = Parser::precedence(op) == 3;
+    if (compare) {
+        // I < 10 compares the same values whether 10 is int16 or double.
+        if (lhs == SType::Int && wholeLiteral(rhsStart, out.code.size())) {
+            makeIntLiteral(rhsStart);
+            rhs = SType::Int;
+        } else if (rhs == SType::Int && wholeLiteral(lhsStart, rhsStart)) {
+            makeIntLiteral(lhsStart);
+            lhs = SType::Int;
+        }
+    }
+
+    Op code = Op::BinOp;
+    if (lhs == SType::Int && rhs == SType::Int) code = Op::BinI;
+    else if (is_numeric(lhs) && is_numeric(rhs)) code = Op::BinN;
+    size_t at = emit(code, static_cast<int32_t>(op));
+    lastBin = BinSite{lhsStart, rhsStart, at, lhs, rhs};
+
+    // Result type, following Parser::applyOp.
+    switch (op) {
+        case TokenKind::Slash:
+        case TokenKind::Caret:
+            return SType::Double;
+        case TokenKind::Plus:
+            if (lhs == SType::String || rhs == SType::String) return SType::String;
+            [[fallthrough]];
+        case TokenKind::Minus:
+        case TokenKind::Star:
+        case TokenKind::KW_MOD:
+            if (code == Op::BinI) return SType::Int;
+            return code == Op::BinN ? SType::Double : SType::Unknown;
+        default:
+            return SType::Int; // comparisons, AND, OR and \ always yield int16
+    }
+}
+
+int Compiler::argList() {
+    int argc = 0;
+    consume(TokenKind::LParen, "'('");
+    if (tok.kind != TokenKind::RParen) {
+        while (true) {
+            expression();
+            ++argc;
+            if (accept(TokenKind::Comma)) continue;
+            break;
+        }
+    }
+    consume(TokenKind::RParen, "')'");
+    return argc;
+}
+
+// Operands are emitted right before their operator and expressions contain no jump
+// targets, so when the last `operands` instructions are all PushConst they are
+// exactly this operator's inputs and it can be evaluated now. Anything that throws
+// (division by zero, overflow) is left for run time to report on the right line.
+bool Compiler::fold(Op op, int32_t a, size_t operands) {
+    if (out.code.size() < operands) return false;
+    size_t first = out.code.size() - operands;
+    Value args[kMaxBuiltinArgs];
+    for (size_t k = 0; k < operands; ++k) {
+        const Instr& in = out.code[first + k];
+        if (in.op != Op::PushConst) return false;
+        args[k] = out.consts[static_cast<size_t>(in.a)];
+    }
+
+    Value r;
+    try {
+        switch (op) {
+            case Op::BinOp: r = Parser::applyOp(args[0], static_cast<TokenKind>(a), args[1]); break;
+            case Op::Neg: r = Parser::negate(args[0]); break;
+            case Op::Not: r = Parser::logicalNot(args[0]); break;
+            case Op::Call:
+                if (!kBuiltins[a].pure) return false;
+                r = call_builtin(env, static_cast<uint8_t>(a), args, operands);
+                break;
+            default: return false;
+        }
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    // A computed string takes string space when it is evaluated and a constant
+    // does not (see Value::literal), so it stays a run-time operation.
+    if (r.isString()) return false;
+
+    // The operands' constants are normally the tail of the pool; drop them too.
+    bool tail = true;
+    for (size_t k = 0; k < operands; ++k) {
+        if (static_cast<size_t>(out.code[first + k].a) != out.consts.size() - operands + k) tail = false;
+    }
+    if (tail) out.consts.resize(out.consts.size() - operands);
+    out.code.resize(first);
+    emit(Op::PushConst, constant(std::move(r)));
+    return true;
+}
+
+Compiler::SType Compiler::primary() {
+    if (tok.kind == TokenKind::Number) {
+        emit(Op::PushConst, constant(Value(tok.number)));
+        advance();
+        return SType::Double;
+    }
+    if (tok.kind == TokenKind::String) {
+        emit(Op::PushConst, constant(Value::literal(tok.str())));
+        advance();
+        return SType::String;
+    }
+    if (tok.kind == TokenKind::Identifier) {
+        std::string nm(tok.text);
+        uint8_t fn = tok.sym ? tok.fn : builtin_id(nm);
+        Token id = tok;
+        advance();
+
+        if (fn && tok.kind == TokenKind::LParen) {
+            int argc = argList();
+            check_builtin_arity(fn, static_cast<size_t>(argc));
+            if (fold(Op::Call, fn, static_cast<size_t>(argc))) return constType();
+            emit(Op::Call, fn, argc);
+            return SType::Unknown;
+        }
+        if (fn == static_cast<uint8_t>(Builtin::TIME)) {
+            emit(Op::Call, fn, 0);
+            return SType::Double;
+        }
+        if (tok.kind == TokenKind::LParen) {
+            if (argList() != 1) throw RuntimeError("Bad subscript");
+            emit(Op::LoadElem, name(nm));
+            return SType::Unknown;
+        }
+        int32_t slot = varSlotOf(id);
+        emit(Op::LoadVar, slot);
+        return varType(slot);
+    }
+    if (tok.kind == TokenKind::LParen) {
+        advance();
+        SType t = expression();
+        consume(TokenKind::RParen, "')'");
+        return t;
+    }
+    if (tok.kind == TokenKind::Minus) {
+        advance();
+        SType t = primary();
+        if (fold(Op::Neg, 0, 1)) return constType();
+        emit(Op::Neg);
+        return is_numeric(t) ? t : SType::Unknown;
+    }
+    if (tok.kind == TokenKind::KW_NOT) {
+        advance();
+        primary();
+        if (!fold(Op::Not, 0, 1)) emit(Op::Not);
+        return SType::Int;
+    }
+    throw ParseError("Expected expression");
+}
+
+// -------------------- Statements --------------------
+
+void Compiler::stmt_PRINT() {
+    bool newline = true;
+    size_t lastPrint = SIZE_MAX;
+
+    while (!atStatementEnd()) {
+        if (tok.kind == TokenKind::Comma) {
+            emit(Op::PrintTab);
+            advance();
+            newline = false;
+            continue;
+        }
+        if (tok.kind == TokenKind::Semicolon) {
+            advance();
+            newline = false;
+            continue;
+        }
+
+        expression();
+        lastPrint = emit(Op::Print);
+
+        if (tok.kind == TokenKind::Comma) {
+            emit(Op::PrintTab);
+            advance();
+            newline = false;
+            continue;
+        }
+        if (tok.kind == TokenKind::Semicolon) {
+            advance();
+            newline = false;
+            continue;
+        }
+
+        if (!atStatementEnd()) {
+            emit(Op::PrintChar, ' ');
+            newline = false;
+        }
+    }
+
+    if (!newline) return;
+    if (lastPrint + 1 == out.code.size()) out.code[lastPrint].op = Op::PrintLine;
+    else emit(Op::PrintChar, '\n');
+}
+
+void Compiler::stmt_LET() {
+    accept(TokenKind::KW_LET);
+
+    if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
+    std::string nm(tok.text);
+    Token target = tok;
+    advance();
+
+    bool isArray = false;
+    if (tok.kind == TokenKind::LParen) {
+        if (argList() != 1) throw RuntimeError("Bad subscript");
+        isArray = true;
+    }
+    int32_t slot = isArray ? 0 : varSlotOf(target);
+
+    consume(TokenKind::Equal, "'='");
+
+    // S$ = S$ + a + b ...: evaluate the pieces, then append them in place. If anything
+    // else follows the last piece, rewind and compile the plain assignment.
+    if (!isArray && nm.back() == '$' && tok.kind == TokenKind::Identifier &&
+        tok.text == target.text && lex.peek() && lex.peek()->kind == TokenKind::Plus) {
+        size_t mark = out.code.size();
+        Lexer savedLex = lex;
+        Token savedTok = tok;
+
+        advance();
+        int pieces = 0;
+        while (tok.kind == TokenKind::Plus) {
+            advance();
+            size_t start = out.code.size();
+            SType t = primary();
+            binOpRHS(Parser::precedence(TokenKind::Plus) + 1, t, start);
+            ++pieces;
+        }
+        if (atStatementEnd()) {
+            emit(Op::AppendVar, slot, pieces);
+            return;
+        }
+
+        out.code.resize(mark);
+        lex = savedLex;
+        tok = savedTok;
+    }
+
+    expression();
+
+    if (isArray) emit(Op::StoreElem, name(nm));
+    else if (!fuseAddVarConst(slot) && !fuseIntStore(slot)) emit(Op::StoreVar, slot);
+}
+
+// V = V + k and V = V - k, with k a numeric literal: the variable is updated in place
+// by one instruction instead of being loaded, added to and stored back.
+bool Compiler::fuseAddVarConst(int32_t slot) {
+    size_t n = out.code.size();
+    if (n < 3 || lastBin.op + 1 != n || lastBin.rhs + 2 != n || lastBin.lhs + 3 != n) return false;
+    const Instr& load = out.code[n - 3];
+    const Instr& push = out.code[n - 2];
+    TokenKind op = static_cast<TokenKind>(out.code[n - 1].a);
+    if (load.op != Op::LoadVar || load.a != slot || push.op != Op::PushConst) return false;
+    if (op != TokenKind::Plus && op != TokenKind::Minus) return false;
+    if (!out.consts[static_cast<size_t>(push.a)].isNumber()) return false;
+
+    uint8_t flag = static_cast<uint8_t>((op == TokenKind::Minus ? 1 : 0) | (wholeLiteral(n - 2, n - 1) ? 2 : 0));
+    int32_t k = push.a;
+    out.code.resize(n - 3);
+    emit(Op::AddVarConst, slot, k, flag);
+    lastBin.op = SIZE_MAX;
+    return true;
+}
+
+// V = a op b into an int16 variable, with both operands int16 or whole literals, runs
+// as one int16 operation: the exact result is range checked once, which is what the
+// double arithmetic followed by the store's conversion would do. Literals are pushed
+// as int16 and flagged so the fallback can give applyOp the doubles the program wrote.
+bool Compiler::fuseIntStore(int32_t slot) {
+    if (varType(slot) != SType::Int || lastBin.op + 1 != out.code.size()) return false;
+    Instr& bin = out.code[lastBin.op];
+    if (bin.op != Op::BinI && bin.op != Op::BinN) return false;
+    TokenKind op = static_cast<TokenKind>(bin.a);
+    if (op != TokenKind::Plus && op != TokenKind::Minus && op != TokenKind::Star &&
+        op != TokenKind::Backslash && op != TokenKind::KW_MOD) return false;
+
+    bool lhsLit = lastBin.lhsType != SType::Int && wholeLiteral(lastBin.lhs, lastBin.rhs);
+    bool rhsLit = lastBin.rhsType != SType::Int && wholeLiteral(lastBin.rhs, lastBin.op);
+    if ((lastBin.lhsType != SType::Int && !lhsLit) || (lastBin.rhsType != SType::Int && !rhsLit)) return false;
+
+    if (lhsLit) makeIntLiteral(lastBin.lhs);
+    if (rhsLit) makeIntLiteral(lastBin.rhs);
+    bin = Instr{Op::StoreIntOp, static_cast<uint8_t>((lhsLit ? 1 : 0) | (rhsLit ? 2 : 0)), slot, static_cast<int32_t>(op)};
+    return true;
+}
+
+void Compiler::stmt_INPUT() {
+    int32_t prompt = -1;
+    if (tok.kind == TokenKind::String) {
+        prompt = constant(Value::literal(tok.str()));
+        advance();
+        if (tok.kind == TokenKind::Semicolon || tok.kind == TokenKind::Comma) advance();
+    }
+
+    while (true) {
+        if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
+        std::string nm(tok.text);
+        Token target = tok;
+        advance();
+
+        bool isArray = false;
+        if (tok.kind == TokenKind::LParen) {
+            if (argList() != 1) throw RuntimeError("Bad subscript");
+            isArray = true;
+        }
+        int32_t slot = isArray ? 0 : varSlotOf(target);
+
+        emit(Op::Input, isArray ? name(nm) : slot, prompt, isArray ? 1 : 0);
+
+        if (accept(TokenKind::Comma)) continue;
+        break;
+    }
+}
+
+void Compiler::stmt_IF() {
+    expression();
+    consume(TokenKind::KW_THEN, "THEN");
+
+    // A false condition skips the entire remainder of the line (':' stays in the THEN-clause).
+    // IF V op k THEN n needs no jump of its own: the GOTO is the last instruction of
+    // the line, so a false IfVarConst simply steps over it.
+    if (tok.kind != TokenKind::Number || !fuseIfVarConst()) lineEndFixups.push_back(emit(Op::JumpIfFalse));
+
+    if (tok.kind == TokenKind::Number) {
+        int target = static_cast<int>(tok.number);
+        lineFixups.push_back({emit(Op::Jump), target});
+        tok = Token{TokenKind::End, "", 0.0};
+        lex.skipToEnd();
+        return;
+    }
+
+    // The THEN-clause is simply the rest of the line.
+    compileStatementList();
+    tok = Token{TokenKind::End, "", 0.0};
+    lex.skipToEnd();
+}
+
+// The condition just compiled is a comparison of a variable with a literal.
+bool Compiler::fuseIfVarConst() {
+    size_t n = out.code.size();
+    if (n < 3 || lastBin.op + 1 != n || lastBin.rhs + 2 != n || lastBin.lhs + 3 != n) return false;
+    const Instr& load = out.code[n - 3];
+    const Instr& push = out.code[n - 2];
+    TokenKind op = static_cast<TokenKind>(out.code[n - 1].a);
+    if (load.op != Op::LoadVar || push.op != Op::PushConst || Parser::precedence(op) != 3) return false;
+
+    Instr fused{Op::IfVarConst, static_cast<uint8_t>(op), load.a, push.a};
+    out.code.resize(n - 3);
+    out.code.push_back(fused);
+    lastBin.op = SIZE_MAX;
+    return true;
+}
+
+void Compiler::stmt_GOTO(bool isGosub) {
+    if (tok.kind != TokenKind::Number) throw ParseError("Expected line number");
+    int target = static_cast<int>(tok.number);
+    advance();
+    // GOSUB returns to the instruction after it: the next statement, or the next line.
+    lineFixups.push_back({emit(isGosub ? Op::Gosub : Op::Jump), target});
+}
+
+void Compiler::stmt_FOR() {
+    if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
+    int32_t var = varSlotOf(tok);
+    uint32_t sym = symbolOf(tok);
+    advance();
+    consume(TokenKind::Equal, "'='");
+    expression();
+    consume(TokenKind::KW_TO, "TO");
+    expression();
+    uint8_t hasStep = 0;
+    if (accept(TokenKind::KW_STEP)) {
+        expression();
+        hasStep = 1;
+    } else {
+        emit(Op::PushConst, constant(Value(1.0)));
+    }
+    // The loop body resumes at the instruction after ForInit.
+    emit(Op::ForInit, var, static_cast<int32_t>(sym), hasStep);
+}
+
+void Compiler::stmt_NEXT() {
+    int32_t var = -1;
+    uint32_t sym = 0;
+    if (tok.kind == TokenKind::Identifier) {
+        var = varSlotOf(tok);
+        sym = symbolOf(tok);
+        advance();
+    }
+    emit(Op::Next, var, static_cast<int32_t>(sym));
+}
+
+void Compiler::stmt_DIM() {
+    while (true) {
+        if (tok.kind != TokenKind::Identifier) throw ParseError("Expected array name");
+        std::string nm(tok.text);
+        advance();
+        consume(TokenKind::LParen, "'('");
+        expression();
+        consume(TokenKind::RParen, "')'");
+        emit(Op::Dim, name(nm));
+
+        if (accept(TokenKind::Comma)) continue;
+        break;
+    }
+}
+
+void Compiler::stmt_ON() {
+    if (tok.kind != TokenKind::KW_INTERVAL) {
+        throw RuntimeError("Unsupported ON event (only ON INTERVAL implemented)");
+    }
+    advance();
+
+    (void)accept(TokenKind::Equal);
+    if (accept(TokenKind::LParen)) {
+        expression();
+        consume(TokenKind::RParen, "')'");
+    } else {
+        expression();
+    }
+
+    consume(TokenKind::KW_GOSUB, "GOSUB");
+    if (tok.kind != TokenKind::Number) throw ParseError("Expected line number");
+    int line = static_cast<int>(tok.number);
+    advance();
+
+    emit(Op::OnInterval, line);
+}
+
+void Compiler::stmt_INTERVAL() {
+    if (tok.kind == TokenKind::KW_ON)   { advance(); emit(Op::IntervalCtl, 0, 0, 0); return; }
+    if (tok.kind == TokenKind::KW_OFF)  { advance(); emit(Op::IntervalCtl, 0, 0, 1); return; }
+    if (tok.kind == TokenKind::KW_STOP) { advance(); emit(Op::IntervalCtl, 0, 0, 2); return; }
+    throw RuntimeError("Expected INTERVAL ON/OFF/STOP");
+}
+
+void Compiler::stmt_LOCATE() {
+    uint8_t present = 0;
+
+    if (tok.kind != TokenKind::Comma && !atStatementEnd()) {
+        expression();
+        present |= 1;
+    }
+    if (accept(TokenKind::Comma)) {
+        if (tok.kind != TokenKind::Comma && !atStatementEnd()) {
+            expression();
+            present |= 2;
+        }
+        if (accept(TokenKind::Comma)) {
+            if (!atStatementEnd()) {
+                expression();
+                present |= 4;
+            }
+        }
+    }
+
+    emit(Op::Locate, 0, 0, present);
+}
+
+void Compiler::stmt_COLOR() {
+    uint8_t present = 0;
+
+    if (tok.kind != TokenKind::Comma && !atStatementEnd()) {
+        expression();
+        present |= 1;
+    }
+    if (accept(TokenKind::Comma)) {
+        if (!atStatementEnd()) {
+            expression();
+            present |= 2;
+        }
+    }
+
+    emit(Op::Color, 0, 0, present);
+}
+
+void Compiler::stmt_RANDOMIZE() {
+    if (atStatementEnd()) {
+        emit(Op::Randomize, 0, 0, 0);
+        return;
+    }
+    expression();
+    emit(Op::Randomize, 0, 0, 1);
+}
+
+void Compiler::stmt_BEEP() {
+    uint8_t n = 0;
+    if (!atStatementEnd()) {
+        expression();
+        ++n;
+        if (accept(TokenKind::Comma)) {
+            expression();
+            ++n;
+        }
+    }
+    emit(Op::Beep, 0, 0, n);
+}
+
+void Compiler::stmt_DEFINT() {
+    auto read_letter = [&]() -> char {
+        if (tok.kind != TokenKind::Identifier || tok.text.empty())
+            throw ParseError("Expected letter in DEFINT");
+        char ch = static_cast<char>(std::toupper(static_cast<unsigned char>(tok.text[0])));
+        if (ch < 'A' || ch > 'Z')
+            throw ParseError("Expected A-Z letter in DEFINT");
+        advance();
+        return ch;
+    };
+
+    while (true) {
+        bool hadParen = accept(TokenKind::LParen);
+
+        char a = read_letter();
+        char b = a;
+        if (accept(TokenKind::Minus)) {
+            b = read_letter();
+        }
+
+        if (hadParen) consume(TokenKind::RParen, "')'");
+
+        emit(Op::DefInt, a, b);
+
+        if (accept(TokenKind::Comma)) continue;
+        break;
+    }
+}
+
+void Compiler::stmt_CLEAR() {
+    if (!atStatementEnd()) {
+        expression();
+        emit(Op::Clear, 0, 0, 1);
+        return;
+    }
+    emit(Op::Clear, 0, 0, 0);
+}
+
+void Compiler::stmt_KEY() {
+    // KEY ON / KEY OFF are accepted and ignored.
+    if (tok.kind == TokenKind::KW_ON || tok.kind == TokenKind::KW_OFF) {
+        advance();
+        return;
+    }
+    throw RuntimeError("Expected KEY ON/OFF");
+}
+
+void Compiler::stmt_READ() {
+    while (true) {
+        if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
+        std::string nm(tok.text);
+        Token target = tok;
+        advance();
+
+        bool isArray = false;
+        if (tok.kind == TokenKind::LParen) {
+            if (argList() != 1) throw RuntimeError("Bad subscript");
+            isArray = true;
+        }
+        int32_t slot = isArray ? 0 : varSlotOf(target);
+
+        emit(Op::Read, isArray ? name(nm) : slot, 0, isArray ? 1 : 0);
+
+        if (accept(TokenKind::Comma)) continue;
+        break;
+    }
+}
+
+void Compiler::stmt_RESTORE() {
+    int line = 0;
+    if (tok.kind == TokenKind::Number) {
+        line = static_cast<int>(tok.number);
+        advance();
+    }
+    emit(Op::Restore, line);
+}
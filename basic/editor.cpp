@@ -15,8 +15,11 @@
 #include <cmath>
 #include <algorithm>
 #include "env.h"
+
+#if BASIC_USE_SDL
 #include "SDL.h"
 #include "SDL_ttf.h"
+#include "glyph_atlas.h"
 
 static TTF_Font* basic_open_mono_font(int pt) {
     // Try a few common monospace font locations on macOS.
@@ -34,18 +37,6 @@ static TTF_Font* basic_open_mono_font(int pt) {
     return nullptr;
 }
 
-static void sdl_draw_text(SDL_Renderer* r, TTF_Font* font, const std::string& s, int x, int y, SDL_Color c) {
-    if (s.empty()) return;
-    SDL_Surface* surf = TTF_RenderUTF8_Blended(font, s.c_str(), c);
-    if (!surf) return;
-    SDL_Texture* tex = SDL_CreateTextureFromSurface(r, surf);
-    if (!tex) { SDL_FreeSurface(surf); return; }
-    SDL_Rect dst{ x, y, surf->w, surf->h };
-    SDL_RenderCopy(r, tex, nullptr, &dst);
-    SDL_DestroyTexture(tex);
-    SDL_FreeSurface(surf);
-}
-
 // Run the editor using the *existing* REPL window/renderer/font.
 // The REPL owns `win`, `ren`, and `font` and is responsible for init/teardown.
 void run_editor_inplace(Env& env,
@@ -62,14 +53,17 @@ void run_editor_inplace(Env& env,
 
     // Build editable lines from program.
     std::vector<std::string> lines;
-    for (auto& [ln, txt] : env.program) {
-        lines.push_back(std::to_string(ln) + " " + txt);
+    for (auto& [ln, pl] : env.program) {
+        lines.push_back(std::to_string(ln) + " " + pl.text);
     }
     if (lines.empty()) lines.push_back("");
 
     int row = 0, col = 0;
     int top = 0;
 
+    GlyphAtlas atlas;
+    atlas.build(ren, font, cellW, cellH);
+
     SDL_StartTextInput();
 
     auto clampCursor = [&]() {
@@ -160,13 +154,14 @@ void run_editor_inplace(Env& env,
         SDL_Color fg{ 220, 220, 220, 255 };
         SDL_Color dim{ 120, 120, 120, 255 };
 
+        atlas.clear();
         for (int screenR = 0; screenR < rows; ++screenR) {
             int i = top + screenR;
             if (i < 0 || i >= (int)lines.size()) continue;
 
-            std::string s = lines[i];
-            if ((int)s.size() > cols) s.resize((size_t)cols);
-            sdl_draw_text(ren, font, s, insetX, insetY + screenR * cellH, fg);
+            std::string_view s = lines[i];
+            if ((int)s.size() > cols) s = s.substr(0, (size_t)cols);
+            atlas.text(insetX, insetY + screenR * cellH, s, fg);
         }
 
         // Cursor (block outline)
@@ -178,32 +173,40 @@ void run_editor_inplace(Env& env,
         if (cursorScreenCol < 0) cursorScreenCol = 0;
         if (cursorScreenCol >= cols) cursorScreenCol = cols - 1;
 
+        // Status line hint (last row overlay)
+        std::string_view hint = "ESC=exit  CTRL+K=delete line";
+        if ((int)hint.size() > cols) hint = hint.substr(0, (size_t)cols);
+        atlas.text(insetX, insetY + (rows - 1) * cellH, hint, dim);
+        atlas.draw(ren);
+
         SDL_SetRenderDrawColor(ren, 255, 255, 255, 255);
         SDL_Rect cur{ insetX + cursorScreenCol * cellW, insetY + cursorScreenRow * cellH, cellW, cellH };
         SDL_RenderDrawRect(ren, &cur);
 
-        // Status line hint (last row overlay)
-        std::string hint = "ESC=exit  CTRL+K=delete line";
-        if ((int)hint.size() > cols) hint.resize((size_t)cols);
-        sdl_draw_text(ren, font, hint, insetX, insetY + (rows - 1) * cellH, dim);
-
         SDL_RenderPresent(ren);
     }
 
     SDL_StopTextInput();
 
-    // Rebuild program from edited lines.
+    // Rebuild program from edited lines. The caller re-tokenizes them.
     env.program.clear();
     for (auto& l : lines) {
         std::istringstream iss(l);
         int ln;
         if (!(iss >> ln)) continue;
+        if (!Env::validLineNumber(ln)) {
+            std::cout << "Bad line number: " << l << "\n";
+            continue;
+        }
         std::string rest;
         std::getline(iss, rest);
         if (!rest.empty()) env.program[ln] = rest.substr(1);
     }
+    env.reindexProgram();
 }
 
+#endif // BASIC_USE_SDL
+
 void run_editor(Env& env) {
     (void)env;
     std::cout << "Editor: in-place SDL editor requires the SDL REPL to call run_editor_inplace(...).\n";
@@ -16,6 +16,7 @@
 #include <stdexcept>
 #include <cstdlib>
 #include <chrono>
+#include <cassert>
 #include <cctype>
 #include <cstring>
 #include <ctime>
@@ -23,6 +24,14 @@
 #include <ostream>
 #include <algorithm>
 #include <functional>
+#include "token.h"
+
+// Build switch for the SDL2/SDL2_ttf front end (window, in-place editor). Build with
+// -DBASIC_USE_SDL=0 for a console-only binary that needs neither library; it runs
+// the terminal REPL, --run and --compile the same way.
+#ifndef BASIC_USE_SDL
+#define BASIC_USE_SDL 1
+#endif
 
 struct Parser;
 
@@ -34,25 +43,172 @@ struct ParseError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+struct StringHeap;
+
+// Shared string buffer behind string Values. Values copy the handle and bump the
+// count instead of copying characters; a buffer is only written to while it has a
+// single owner (see Value::editString).
+struct StringRep {
+    // `refs` of the shared "" buffer: it is never counted or freed, so every thread
+    // can hold it without writing to it.
+    static constexpr uint32_t kImmortal = UINT32_MAX;
+
+    uint32_t refs = 1;
+    uint32_t counted = 0;        // bytes charged to `heap` for this buffer
+    StringHeap* heap = nullptr;  // heap it was allocated from and is freed to, if any
+    std::string str;
+
+    explicit StringRep(std::string s, uint32_t r = 1) : refs(r), str(std::move(s)) {}
+
+    static StringRep* make(std::string s);
+
+    static StringRep* empty() {
+        static StringRep* e = new StringRep(std::string(), kImmortal);
+        return e;
+    }
+
+    void retain() {
+        if (refs != kImmortal) ++refs;
+    }
+    void release();
+};
+
+// String heap of an Env: recycles StringRep headers through a free list and keeps
+// the byte count that FRE() reports. Strings are refcounted, so space is reclaimed
+// as soon as the last Value holding it goes away.
+struct StringHeap {
+    // Nominal string space reported by FRE(), in bytes (not a hard limit).
+    static constexpr size_t kStringSpace = 65535;
+
+    size_t bytesInUse = 0;
+    size_t liveStrings = 0;
+    std::vector<StringRep*> freeList;
+
+    // The heap new strings are allocated from: that of the one Env in the process
+    // (see Env()). A string goes back to the heap that allocated it.
+    static StringHeap*& active() {
+        static StringHeap* h = nullptr;
+        return h;
+    }
+
+    ~StringHeap() {
+        trim();
+        if (active() == this) active() = nullptr;
+    }
+
+    StringRep* alloc(std::string s) {
+        StringRep* r;
+        if (!freeList.empty()) {
+            r = freeList.back();
+            freeList.pop_back();
+            r->refs = 1;
+            r->str = std::move(s);
+        } else {
+            r = new StringRep(std::move(s));
+        }
+        r->heap = this;
+        charge(r);
+        ++liveStrings;
+        return r;
+    }
+
+    void free(StringRep* r) {
+        bytesInUse -= r->counted;
+        r->counted = 0;
+        --liveStrings;
+        // Keep small buffers for reuse; give large ones back to the allocator.
+        if (freeList.size() < 1024 && r->str.capacity() <= 256) {
+            r->str.clear();
+            freeList.push_back(r);
+        } else {
+            delete r;
+        }
+    }
+
+    // Re-charge a buffer after it was edited in place.
+    void charge(StringRep* r) {
+        bytesInUse -= r->counted;
+        r->counted = static_cast<uint32_t>(r->str.size());
+        bytesInUse += r->counted;
+    }
+
+    // Release recycled headers (FRE("") in GW-BASIC forces garbage collection).
+    void trim() {
+        for (StringRep* r : freeList) delete r;
+        freeList.clear();
+        freeList.shrink_to_fit();
+    }
+
+    double freeBytes() const {
+        return bytesInUse >= kStringSpace ? 0.0 : static_cast<double>(kStringSpace - bytesInUse);
+    }
+};
+
+inline StringRep* StringRep::make(std::string s) {
+    if (StringHeap* h = StringHeap::active()) return h->alloc(std::move(s));
+    return new StringRep(std::move(s));
+}
+
+inline void StringRep::release() {
+    if (refs == kImmortal || --refs != 0) return;
+    if (heap) heap->free(this);
+    else delete this;
+}
+
 struct Value {
     // BASIC values: integer (16-bit), double, string.
-    std::variant<int16_t, double, std::string> data;
-
-    Value() : data(0.0) {}
-    explicit Value(double d) : data(d) {}
-    explicit Value(int16_t i) : data(i) {}
-    explicit Value(const std::string& s) : data(s) {}
+    // 16 bytes: a type tag plus an inline number or a string handle.
+    enum class Type : uint8_t { Int16, Double, String };
+
+    Type type;
+    union Payload {
+        int16_t i;
+        double d;
+        StringRep* s;
+    } p;
+
+    Value() : type(Type::Double) { p.d = 0.0; }
+    explicit Value(double d) : type(Type::Double) { p.d = d; }
+    explicit Value(int16_t i) : type(Type::Int16) { p.i = i; }
+    explicit Value(const std::string& s) : type(Type::String) { p.s = s.empty() ? StringRep::empty() : StringRep::make(s); }
+    explicit Value(std::string&& s) : type(Type::String) { p.s = s.empty() ? StringRep::empty() : StringRep::make(std::move(s)); }
+
+    Value(const Value& o) : type(o.type), p(o.p) {
+        if (type == Type::String) p.s->retain();
+    }
+    Value(Value&& o) noexcept : type(o.type), p(o.p) {
+        o.type = Type::Double;
+        o.p.d = 0.0;
+    }
+    Value& operator=(const Value& o) {
+        if (o.type == Type::String) o.p.s->retain();
+        release();
+        type = o.type;
+        p = o.p;
+        return *this;
+    }
+    Value& operator=(Value&& o) noexcept {
+        if (this != &o) {
+            release();
+            type = o.type;
+            p = o.p;
+            o.type = Type::Double;
+            o.p.d = 0.0;
+        }
+        return *this;
+    }
+    ~Value() { release(); }
 
-    bool isString() const { return std::holds_alternative<std::string>(data); }
-    bool isInt() const { return std::holds_alternative<int16_t>(data); }
-    bool isDouble() const { return std::holds_alternative<double>(data); }
-    bool isNumber() const { return isInt() || isDouble(); }
+    bool isString() const { return type == Type::String; }
+    bool isInt() const { return type == Type::Int16; }
+    bool isDouble() const { return type == Type::Double; }
+    bool isNumber() const { return type != Type::String; }
 
     double asNumber() const {
-        if (isDouble()) return std::get<double>(data);
-        if (isInt()) return static_cast<double>(std::get<int16_t>(data));
+        if (isDouble()) return p.d;
+        if (isInt()) return static_cast<double>(p.i);
         // string-to-number: GW-BASIC tries to convert leading numeric
-        const std::string& s = std::get<std::string>(data);
+        const std::string& s = p.s->str;
         char* end = nullptr;
         double v = std::strtod(s.c_str(), &end);
         if (end == s.c_str()) return 0.0;
@@ -67,56 +223,254 @@ struct Value {
     }
 
     int16_t asInt() const {
-        if (isInt()) return std::get<int16_t>(data);
-        if (isDouble()) return toInt16Checked(std::get<double>(data));
+        if (isInt()) return p.i;
+        if (isDouble()) return toInt16Checked(p.d);
         return toInt16Checked(asNumber());
     }
 
     const std::string& asString() const {
-        if (isString()) return std::get<std::string>(data);
+        if (isString()) return p.s->str;
         static thread_local std::string temp;
         std::ostringstream oss;
-        if (isInt()) oss << static_cast<int>(std::get<int16_t>(data));
+        if (isInt()) oss << static_cast<int>(p.i);
         else {
             oss.setf(std::ios::fmtflags(0), std::ios::floatfield);
-            oss << std::get<double>(data);
+            oss << p.d;
         }
         temp = oss.str();
         return temp;
     }
 
     static Value fromBool(bool b) { return Value(static_cast<int16_t>(b ? 1 : 0)); }
+
+    // A string literal of the program. Like GW-BASIC, which points literals at the
+    // program text, it takes no string space: FRE() only counts computed strings,
+    // whichever engine runs the program.
+    static Value literal(std::string s) {
+        Value v;
+        v.type = Type::String;
+        v.p.s = s.empty() ? StringRep::empty() : new StringRep(std::move(s));
+        return v;
+    }
+
+    // Copy-on-write edit of a string Value: the buffer is copied first if it is
+    // shared or is not in the heap (a literal), then `edit(std::string&)` runs on
+    // the now uniquely owned text.
+    template <typename F>
+    void editString(F&& edit) {
+        if (p.s->refs != 1 || !p.s->heap) {
+            StringRep* own = StringRep::make(p.s->str);
+            p.s->release();
+            p.s = own;
+        }
+        edit(p.s->str);
+        if (StringHeap* h = p.s->heap) h->charge(p.s);
+    }
+
+private:
+    void release() {
+        if (type == Type::String) p.s->release();
+    }
+};
+static_assert(sizeof(Value) == 16, "Value should stay two words");
+
+// A stored program line: the original text (LIST/SAVE) plus its token stream,
+// produced once when the line is entered so execution never re-lexes it.
+struct ProgramLine {
+    std::string text;
+    std::vector<Token> tokens; // terminated by an End token; empty until tokenized
+    std::vector<uint32_t> stmtStarts; // token index of each ':'-separated statement
+    std::string lexError;      // deferred lexer error, raised when execution reaches it
+
+    ProgramLine() = default;
+    ProgramLine(std::string t) : text(std::move(t)) {}
+    // Tokens view `text`, so a copied or moved line keeps only the text and is
+    // tokenized again before it runs.
+    ProgramLine(const ProgramLine& o) : text(o.text) {}
+    ProgramLine(ProgramLine&& o) noexcept : text(std::move(o.text)) {}
+    ProgramLine& operator=(const ProgramLine& o) { return *this = ProgramLine(o); }
+    ProgramLine& operator=(ProgramLine&& o) noexcept {
+        text = std::move(o.text);
+        tokens.clear();
+        stmtStarts.clear();
+        lexError.clear();
+        return *this;
+    }
+
+    bool tokenized() const { return !tokens.empty(); }
+
+    // First token of statement `stmt`; past the last statement, the End token.
+    size_t stmtToken(size_t stmt) const {
+        return stmt < stmtStarts.size() ? stmtStarts[stmt] : tokens.size() - 1;
+    }
+    // Character offset of statement `stmt` in `text` (for DEBUG).
+    size_t stmtOffset(size_t stmt) const { return tokens[stmtToken(stmt)].start; }
 };
 
 struct Env {
-    // Variables
-    std::unordered_map<std::string, Value> vars;
+    // Declared first so it outlives every Value stored in the Env.
+    StringHeap strings;
+
+    // One Env per process (the interpreter's, or a compiled program's): new strings
+    // come from its heap through StringHeap::active(), which it must not take over
+    // from another live Env.
+    Env() {
+        assert(!StringHeap::active() && "only one Env may exist at a time");
+        StringHeap::active() = &strings;
+    }
+    Env(const Env&) = delete;
+    Env& operator=(const Env&) = delete;
+
+    // Program: line number -> original line text (after number) and its tokens
+    std::map<int, ProgramLine> program;
+
+    // Dense index over `program`: one record per line in ascending order plus a
+    // line number -> slot table. Execution addresses lines by slot, so jumps are a
+    // table lookup and sequential lines sit next to each other.
+    // Call storeLine/eraseLine to edit, or reindexProgram() after editing `program` directly.
+    struct LineRecord {
+        int number;
+        ProgramLine* line;
+    };
+    std::vector<LineRecord> lines;
+    std::vector<int32_t> slotOfLine; // indexed by line number, -1 = no such line
+    uint64_t programVersion = 1;     // bumped on every program edit; keys the compiled-code cache
+
+    // Highest line number (as in GW-BASIC). It also bounds slotOfLine, so every
+    // path that stores a line must check it first.
+    static constexpr int kMaxLineNumber = 65529;
+    static bool validLineNumber(int ln) { return ln > 0 && ln <= kMaxLineNumber; }
+
+    // Slot of `ln`, or -1.
+    int32_t slotFor(int ln) const {
+        if (ln < 0 || static_cast<size_t>(ln) >= slotOfLine.size()) return -1;
+        return slotOfLine[static_cast<size_t>(ln)];
+    }
+
+    ProgramLine& storeLine(int ln) {
+        ++programVersion;
+        auto [it, inserted] = program.try_emplace(ln);
+        if (inserted) {
+            auto pos = std::lower_bound(lines.begin(), lines.end(), ln,
+                                        [](const LineRecord& r, int n) { return r.number < n; });
+            size_t slot = static_cast<size_t>(pos - lines.begin());
+            lines.insert(pos, LineRecord{ln, &it->second});
+            if (static_cast<size_t>(ln) >= slotOfLine.size()) slotOfLine.resize(static_cast<size_t>(ln) + 1, -1);
+            renumberSlotsFrom(slot);
+        }
+        return it->second;
+    }
+
+    void eraseLine(int ln) {
+        int32_t slot = slotFor(ln);
+        if (slot < 0) return;
+        ++programVersion;
+        program.erase(ln);
+        lines.erase(lines.begin() + slot);
+        slotOfLine[static_cast<size_t>(ln)] = -1;
+        renumberSlotsFrom(static_cast<size_t>(slot));
+    }
+
+    void reindexProgram() {
+        ++programVersion;
+        lines.clear();
+        slotOfLine.clear();
+        if (!program.empty()) slotOfLine.assign(static_cast<size_t>(program.rbegin()->first) + 1, -1);
+        for (auto& [ln, pl] : program) {
+            slotOfLine[static_cast<size_t>(ln)] = static_cast<int32_t>(lines.size());
+            lines.push_back(LineRecord{ln, &pl});
+        }
+    }
+
+    void renumberSlotsFrom(size_t slot) {
+        for (size_t i = slot; i < lines.size(); ++i) {
+            slotOfLine[static_cast<size_t>(lines[i].number)] = static_cast<int32_t>(i);
+        }
+    }
+
+    // Interned identifier names (upper-cased), shared by all tokenized lines.
+    // Id 0 is reserved for "not interned".
+    std::vector<std::string> symbolNames{std::string()};
+    std::unordered_map<std::string, uint32_t> symbolIds;
+
+    uint32_t internSymbol(const std::string& upper) {
+        auto it = symbolIds.find(upper);
+        if (it != symbolIds.end()) return it->second;
+        uint32_t id = static_cast<uint32_t>(symbolNames.size());
+        symbolNames.push_back(upper);
+        symbolIds.emplace(upper, id);
+        return id;
+    }
+
+    // FOR loop limit and step, shared by both engines. Integer control variables
+    // (I%, DEFINT) count in int16 when the limit and STEP are whole int16 values;
+    // everything else counts in double, exactly as NEXT always has.
+    struct ForCounter {
+        double endValue = 0.0;
+        double step = 1.0;
+        int16_t iEnd = 0;
+        int16_t iStep = 0;
+        bool isInt = false;
+    };
 
-    // Program: line number -> original line text (after number)
-    std::map<int, std::string> program;
+    // Call after the control variable has been assigned its start value.
+    ForCounter makeForCounter(uint32_t slot, double end, double step) const {
+        ForCounter c;
+        c.endValue = end;
+        c.step = step;
+        auto whole16 = [](double x) { return x == std::trunc(x) && x >= -32768.0 && x <= 32767.0; };
+        if (vars[slot].type == VarType::Int16 && whole16(end) && whole16(step)) {
+            c.iEnd = static_cast<int16_t>(end);
+            c.iStep = static_cast<int16_t>(step);
+            c.isInt = true;
+        }
+        return c;
+    }
+
+    // NEXT: advances the control variable in place; true if the loop runs again.
+    bool stepFor(uint32_t slot, const ForCounter& c) {
+        VarSlot& s = vars[slot];
+        if (s.bound) {
+            if (c.isInt && s.value.isInt()) {
+                int cur = s.value.p.i + c.iStep;
+                if (cur < -32768 || cur > 32767) throw RuntimeError("Overflow");
+                s.value.p.i = static_cast<int16_t>(cur);
+                return (c.iStep >= 0) ? (cur <= c.iEnd) : (cur >= c.iEnd);
+            }
+            if (s.value.isDouble() && s.type == VarType::Double) {
+                double cur = s.value.p.d + c.step;
+                s.value.p.d = cur;
+                return (c.step >= 0.0) ? (cur <= c.endValue) : (cur >= c.endValue);
+            }
+        }
+        // Unbound (CLEAR inside the loop) or a string variable: the general path.
+        double cur = getVar(slot).asNumber() + c.step;
+        setVar(slot, Value(cur));
+        return (c.step >= 0.0) ? (cur <= c.endValue) : (cur >= c.endValue);
+    }
 
     // For stack (FOR/NEXT)
     struct ForFrame {
-        std::string var;
-        double endValue;
-        double step;
-        std::map<int, std::string>::iterator returnIt; // line iterator to resume
-        size_t posInLine; // character position within the line to restart after FOR body
+        uint32_t sym;      // interned upper-cased control variable, for NEXT matching
+        uint32_t var;      // variable slot of the control variable
+        ForCounter counter;
+        size_t returnSlot; // line slot to resume
+        size_t returnStmt; // statement index within that line where the FOR body starts
     };
     std::vector<ForFrame> forStack;
 
     // Gosub/Return stack
     struct GosubFrame {
-        std::map<int, std::string>::iterator it;
-        size_t pos;
+        size_t slot;
+        size_t stmt;
         bool isInterval = false; // true only for ON INTERVAL interrupt returns
         size_t savedDataPtr = 0; // snapshot of DATA pointer for interval ISR
     };
     std::vector<GosubFrame> gosubStack;
 
     // Execution state
-    std::map<int, std::string>::iterator pc;
-    size_t posInLine = 0; // position within current line text
+    size_t pc = 0;        // slot of the current line; lines.size() = end of program
+    size_t stmtInLine = 0; // statement index within the current line (ProgramLine::stmtStarts)
     bool running = false;
     bool stopped = false;
     bool contAvailable = false;
@@ -147,6 +501,9 @@ struct Env {
     struct ScreenDriver {
         // Output a single character (including '\n').
         std::function<void(char)> putChar;
+        // Output a run of characters; used for strings, numbers and padding instead of
+        // one putChar call per byte. May be left empty if putChar is set.
+        std::function<void(std::string_view)> write;
         // Clear the screen.
         std::function<void()> cls;
         // Move cursor to 1-based (row, col).
@@ -189,6 +546,30 @@ struct Env {
         if (b > 'Z') b = 'Z';
         if (a > b) std::swap(a, b);
         for (char c = a; c <= b; ++c) defInt[c - 'A'] = on;
+
+        // A variable's type follows DEFINT at every assignment, so variables already
+        // assigned under the old default switch too. The value is converted now
+        // because the VM's fast paths keep a slot's value in its declared type. A value
+        // outside the int16 range cannot be: the slot is unbound, keeping its value,
+        // and takes its new type at the next assignment (see setVar).
+        for (size_t i = 1; i < vars.size(); ++i) {
+            VarSlot& s = vars[i];
+            if (!s.bound || s.type == VarType::String) continue;
+            VarType t = varTypeForName(varNames[i]);
+            if (t == s.type) continue;
+            if (t == VarType::Int16) {
+                double whole = std::trunc(s.value.asNumber());
+                if (!(whole >= -32768.0 && whole <= 32767.0)) {
+                    s.bound = false;
+                    s.retype = true;
+                    continue;
+                }
+                s.value = Value(s.value.asInt());
+            } else {
+                s.value = Value(s.value.asNumber());
+            }
+            s.type = t;
+        }
     }
 
     void clearDefInt() {
@@ -199,6 +580,31 @@ struct Env {
     double lastRnd = 0.0;
     bool hasLastRnd = false;
 
+    // Scalar variables: one slot per distinct name (case-sensitive), assigned when a
+    // line is tokenized, with the values of the current run in a flat array.
+    // varSlots is the name -> slot side table for immediate mode, dumpVars and CLEAR.
+    // A slot's type is fixed from its suffix / DEFINT when it is first assigned.
+    // Slot 0 is reserved for "not resolved".
+    struct VarSlot {
+        Value value;
+        VarType type = VarType::Double;
+        bool bound = false;  // `type` is fixed (first assignment)
+        bool retype = false; // unbound by DEFINT but keeps `value` until assigned
+    };
+    std::vector<std::string> varNames{std::string()};
+    std::unordered_map<std::string, uint32_t> varSlots;
+    std::vector<VarSlot> vars{VarSlot{}};
+
+    uint32_t varSlot(const std::string& name) {
+        auto it = varSlots.find(name);
+        if (it != varSlots.end()) return it->second;
+        uint32_t slot = static_cast<uint32_t>(varNames.size());
+        varNames.push_back(name);
+        vars.emplace_back();
+        varSlots.emplace(name, slot);
+        return slot;
+    }
+
     // Arrays: 1-D only (GW-BASIC style), indexed 0..N
     struct Array {
         VarType type = VarType::Double;
@@ -210,7 +616,7 @@ struct Env {
         // CLEAR/CLEAR-like: reset variables/arrays but keep program + control-flow intact.
         // Many GW-BASIC programs use CLEAR n as a memory-tuning hint and do not expect
         // it to break active FOR/NEXT or GOSUB/RETURN state.
-        vars.clear();
+        for (VarSlot& v : vars) v = VarSlot{};
         arrays.clear();
 
         // DATA/READ state
@@ -224,6 +630,11 @@ struct Env {
     void clearProgramAndState() {
         // NEW: clear the stored program and reset runtime state.
         program.clear();
+        lines.clear();
+        slotOfLine.clear();
+        ++programVersion;
+        symbolNames.assign(1, std::string());
+        symbolIds.clear();
         clearDefInt();
 
         // Control-flow stacks
@@ -251,22 +662,24 @@ struct Env {
         hasLastRnd = false;
 
         // Variables and arrays
-        vars.clear();
+        varNames.assign(1, std::string());
+        varSlots.clear();
+        vars.assign(1, VarSlot{});
         arrays.clear();
 
-        pc = program.end();
+        pc = 0;
         running = false;
         stopped = false;
         contAvailable = false;
-        posInLine = 0;
+        stmtInLine = 0;
         // Do not call clearVars() here; already cleared above.
     }
 
-    Value getVar(const std::string& name) {
-        auto it = vars.find(name);
-        if (it != vars.end()) return it->second;
+    Value getVar(uint32_t slot) {
+        const VarSlot& s = vars[slot];
+        if (s.bound || s.retype) return s.value;
 
-        switch (varTypeForName(name)) {
+        switch (varTypeForName(varNames[slot])) {
             case VarType::String: return Value(std::string(""));
             case VarType::Int16:  return Value(static_cast<int16_t>(0));
             case VarType::Double: return Value(0.0);
@@ -274,20 +687,44 @@ struct Env {
         return Value(0.0);
     }
 
-    void setVar(const std::string& name, const Value& v) {
-        switch (varTypeForName(name)) {
+    void setVar(uint32_t slot, const Value& v) {
+        VarSlot& s = vars[slot];
+        if (!s.bound) {
+            s.type = varTypeForName(varNames[slot]);
+            s.bound = true;
+            s.retype = false;
+        }
+        switch (s.type) {
             case VarType::String:
-                vars[name] = v.isString() ? v : Value(v.asString());
+                s.value = v.isString() ? v : Value(v.asString());
                 return;
             case VarType::Int16:
-                vars[name] = Value(v.asInt());
+                s.value = Value(v.asInt());
                 return;
             case VarType::Double:
-                vars[name] = Value(v.asNumber());
+                s.value = Value(v.asNumber());
                 return;
         }
     }
 
+    // S$ = S$ + tail, appended into the variable's own buffer. Capacity at least
+    // doubles when it runs out, so building a string piece by piece is linear.
+    void appendToVar(uint32_t slot, const std::string& tail) {
+        VarSlot& s = vars[slot];
+        if (!s.bound || !s.value.isString()) {
+            setVar(slot, Value(getVar(slot).asString() + tail));
+            return;
+        }
+        s.value.editString([&](std::string& str) {
+            size_t need = str.size() + tail.size();
+            if (need > str.capacity()) str.reserve(std::max(need, str.capacity() * 2));
+            str.append(tail);
+        });
+    }
+
+    Value getVar(const std::string& name) { return getVar(varSlot(name)); }
+    void setVar(const std::string& name, const Value& v) { setVar(varSlot(name), v); }
+
     void dimArray(const std::string& name, int upperBound) {
         if (upperBound < 0) throw RuntimeError("Bad subscript");
 
@@ -351,7 +788,7 @@ struct Env {
     void dumpVars(std::ostream& os) const {
         auto valueToString = [](const Value& v) -> std::string {
             if (v.isString()) {
-                const auto& s = std::get<std::string>(v.data);
+                const auto& s = v.asString();
                 std::string out;
                 out.reserve(s.size() + 2);
                 out.push_back('"');
@@ -363,26 +800,23 @@ struct Env {
                 return out;
             }
             if (v.isInt()) {
-                return std::to_string(static_cast<int>(std::get<int16_t>(v.data)));
+                return std::to_string(static_cast<int>(v.asInt()));
             }
             std::ostringstream oss;
             oss.setf(std::ios::fmtflags(0), std::ios::floatfield);
-            oss << std::get<double>(v.data);
+            oss << v.asNumber();
             return oss.str();
         };
 
         // Scalars
-        os << "  Scalars (" << vars.size() << ")\n";
-        if (!vars.empty()) {
-            std::vector<std::string> names;
-            names.reserve(vars.size());
-            for (const auto& kv : vars) names.push_back(kv.first);
-            std::sort(names.begin(), names.end());
-            for (const auto& name : names) {
-                auto it = vars.find(name);
-                if (it == vars.end()) continue;
-                os << "    " << name << " = " << valueToString(it->second) << "\n";
-            }
+        std::vector<std::pair<std::string, uint32_t>> names;
+        for (const auto& [name, slot] : varSlots) {
+            if (vars[slot].bound || vars[slot].retype) names.emplace_back(name, slot);
+        }
+        os << "  Scalars (" << names.size() << ")\n";
+        std::sort(names.begin(), names.end());
+        for (const auto& [name, slot] : names) {
+            os << "    " << name << " = " << valueToString(vars[slot].value) << "\n";
         }
 
         // Arrays
@@ -462,12 +896,13 @@ struct Env {
         quoted.push_back(!t.empty() && t.front()=='"' && t.back()=='"');
     }
 
-    inline void rebuildDataCache(const std::map<int,std::string>& program) {
+    inline void rebuildDataCache(const std::map<int, ProgramLine>& program) {
         dataCache.clear();
         dataPtr = 0;
         dataCacheBuilt = true;
 
-        for (auto& [ln, text] : program) {
+        for (auto& [ln, line] : program) {
+            const std::string& text = line.text;
             // scan statement-by-statement for DATA (start or after ':')
             size_t i = 0;
             bool stmtStart = true;
@@ -528,11 +963,11 @@ struct Env {
         }
     }
 
-    inline void ensureDataCache(const std::map<int,std::string>& program) {
+    inline void ensureDataCache(const std::map<int, ProgramLine>& program) {
         if (!dataCacheBuilt) rebuildDataCache(program);
     }
 
-    inline void restoreData(int lineOr0, const std::map<int,std::string>& program) {
+    inline void restoreData(int lineOr0, const std::map<int, ProgramLine>& program) {
         ensureDataCache(program);
         if (lineOr0 <= 0) { dataPtr = 0; return; }
         size_t i = 0;
@@ -540,7 +975,7 @@ struct Env {
         dataPtr = i;
     }
 
-    inline Value readNextData(bool wantString, const std::map<int,std::string>& program) {
+    inline Value readNextData(bool wantString, const std::map<int, ProgramLine>& program) {
         ensureDataCache(program);
         if (dataPtr >= dataCache.size()) throw RuntimeError("Out of data");
         const auto& it = dataCache[dataPtr++];
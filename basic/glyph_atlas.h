@@ -0,0 +1,136 @@
+//
+//  glyph_atlas.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+#include <string_view>
+#include <vector>
+#include "SDL.h"
+#include "SDL_ttf.h"
+
+// Text drawing for the SDL console and editor. The font is rendered once, in white,
+// into a 16x16 grid of character cells (codes 32..126 and Latin-1 160..255). Cell 0 is
+// solid white, so background rectangles come from the same texture. A frame queues
+// coloured quads (the vertex colour tints the white glyphs) and draw() submits them
+// all with one SDL_RenderGeometry call (SDL 2.0.18 or later; older SDL copies each quad).
+struct GlyphAtlas {
+    SDL_Texture* tex = nullptr;
+    int cellW = 0;
+    int cellH = 0;
+
+    GlyphAtlas() = default;
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+    ~GlyphAtlas() { reset(); }
+
+    bool ready() const { return tex != nullptr; }
+
+    // Drop the texture; call when the font changes or the renderer is lost.
+    void reset() {
+        if (tex) SDL_DestroyTexture(tex);
+        tex = nullptr;
+    }
+
+    bool build(SDL_Renderer* r, TTF_Font* font, int w, int h) {
+        reset();
+        if (!font || w <= 0 || h <= 0) return false;
+        cellW = w;
+        cellH = h;
+
+        SDL_Surface* sheet = SDL_CreateRGBSurfaceWithFormat(0, 16 * w, 16 * h, 32, SDL_PIXELFORMAT_RGBA32);
+        if (!sheet) return false;
+        SDL_Rect solid{ 0, 0, w, h };
+        SDL_FillRect(sheet, &solid, SDL_MapRGBA(sheet->format, 255, 255, 255, 255));
+
+        const SDL_Color white{ 255, 255, 255, 255 };
+        for (int ch = 32; ch < 256; ++ch) {
+            if (ch == ' ' || (ch >= 127 && ch < 160)) continue;
+            SDL_Surface* g = TTF_RenderGlyph_Blended(font, static_cast<Uint16>(ch), white);
+            if (!g) continue;
+            SDL_SetSurfaceBlendMode(g, SDL_BLENDMODE_NONE);
+            SDL_Rect cell{ (ch & 15) * w, (ch >> 4) * h, w, h };
+            SDL_SetClipRect(sheet, &cell); // a wide glyph must not spill into its neighbour
+            SDL_BlitSurface(g, nullptr, sheet, &cell);
+            SDL_FreeSurface(g);
+        }
+        SDL_SetClipRect(sheet, nullptr);
+
+        tex = SDL_CreateTextureFromSurface(r, sheet);
+        SDL_FreeSurface(sheet);
+        if (!tex) return false;
+        SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
+        return true;
+    }
+
+    // -------------------- Frame batch --------------------
+
+    void clear() { quads.clear(); }
+
+    void fill(int x, int y, int w, int h, SDL_Color c) {
+        // Sample the middle of the solid cell so filtering never reaches a glyph.
+        float u = (cellW * 0.5f) / (16.0f * cellW);
+        float v = (cellH * 0.5f) / (16.0f * cellH);
+        quads.push_back({ { x, y, w, h }, c, u, v, u, v });
+    }
+
+    void glyph(int x, int y, unsigned char ch, SDL_Color c) {
+        if (!tex || ch <= ' ' || (ch >= 127 && ch < 160)) return;
+        float u0 = (ch & 15) / 16.0f, v0 = (ch >> 4) / 16.0f;
+        quads.push_back({ { x, y, cellW, cellH }, c, u0, v0, u0 + 1.0f / 16.0f, v0 + 1.0f / 16.0f });
+    }
+
+    void text(int x, int y, std::string_view s, SDL_Color c) {
+        for (char ch : s) {
+            glyph(x, y, static_cast<unsigned char>(ch), c);
+            x += cellW;
+        }
+    }
+
+    void draw(SDL_Renderer* r) {
+        if (quads.empty()) return;
+#if SDL_VERSION_ATLEAST(2,0,18)
+        verts.clear();
+        indices.clear();
+        for (const Quad& q : quads) {
+            int base = static_cast<int>(verts.size());
+            float x0 = static_cast<float>(q.dst.x), y0 = static_cast<float>(q.dst.y);
+            float x1 = static_cast<float>(q.dst.x + q.dst.w), y1 = static_cast<float>(q.dst.y + q.dst.h);
+            verts.push_back({ { x0, y0 }, q.color, { q.u0, q.v0 } });
+            verts.push_back({ { x1, y0 }, q.color, { q.u1, q.v0 } });
+            verts.push_back({ { x1, y1 }, q.color, { q.u1, q.v1 } });
+            verts.push_back({ { x0, y1 }, q.color, { q.u0, q.v1 } });
+            for (int k : { 0, 1, 2, 0, 2, 3 }) indices.push_back(base + k);
+        }
+        SDL_RenderGeometry(r, tex, verts.data(), static_cast<int>(verts.size()),
+                           indices.data(), static_cast<int>(indices.size()));
+#else
+        // No geometry API before SDL 2.0.18: one fill or copy per queued quad.
+        for (const Quad& q : quads) {
+            if (q.u0 == q.u1) {
+                SDL_SetRenderDrawColor(r, q.color.r, q.color.g, q.color.b, q.color.a);
+                SDL_RenderFillRect(r, &q.dst);
+            } else {
+                SDL_Rect src{ (int)(q.u0 * 16 * cellW + 0.5f), (int)(q.v0 * 16 * cellH + 0.5f), cellW, cellH };
+                SDL_SetTextureColorMod(tex, q.color.r, q.color.g, q.color.b);
+                SDL_RenderCopy(r, tex, &src, &q.dst);
+            }
+        }
+#endif
+    }
+
+private:
+    // A queued rectangle and the part of the atlas it shows (u0 == u1 for a fill).
+    struct Quad {
+        SDL_Rect dst;
+        SDL_Color color;
+        float u0, v0, u1, v1;
+    };
+    std::vector<Quad> quads;
+#if SDL_VERSION_ATLEAST(2,0,18)
+    std::vector<SDL_Vertex> verts;
+    std::vector<int> indices;
+#endif
+};
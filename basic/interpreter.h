@@ -8,6 +8,7 @@
 #pragma once
 
 #include <atomic>
+#include <cerrno>
 #include <csignal>
 #include <termios.h>
 #include <unistd.h>
@@ -32,7 +33,11 @@
 #include "parser.h"
 #include "token.h"
 #include "lexer.h"
+#include "bytecode.h"
+#include "jit.h"
+#include "transpile.h"
 
+#if BASIC_USE_SDL
 #include "SDL.h"
 #include "SDL_ttf.h"
 
@@ -47,6 +52,7 @@ void run_editor_inplace(Env& env,
                         int cellH,
                         int insetX,
                         int insetY);
+#endif
 
 static std::string normalize_keywords_upper_preserve(const std::string& line) {
     Lexer lx(line);
@@ -88,6 +94,49 @@ static std::string normalize_keywords_upper_preserve(const std::string& line) {
     return out;
 }
 
+// Output buffer for headless runs (--run). While alive it is std::cout's buffer, so
+// PRINT output and error messages stay in order and reach stdout in 64 KiB blocks.
+// std::cin is tied to std::cout, so INPUT flushes it before reading.
+class BatchOutput : public std::streambuf {
+public:
+    BatchOutput() : previous(std::cout.rdbuf(this)) { setp(buf, buf + sizeof(buf)); }
+    ~BatchOutput() {
+        sync();
+        std::cout.rdbuf(previous);
+    }
+    BatchOutput(const BatchOutput&) = delete;
+    BatchOutput& operator=(const BatchOutput&) = delete;
+
+protected:
+    int_type overflow(int_type ch) override {
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+
+    int sync() override {
+        const char* p = pbase();
+        while (p < pptr()) {
+            ssize_t n = ::write(STDOUT_FILENO, p, static_cast<size_t>(pptr() - p));
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                setp(buf, buf + sizeof(buf));
+                return -1;
+            }
+            p += n;
+        }
+        setp(buf, buf + sizeof(buf));
+        return 0;
+    }
+
+private:
+    char buf[1 << 16];
+    std::streambuf* previous;
+};
+
 struct ScopedRawInput {
     termios old{};
     bool active = false;
@@ -142,10 +191,27 @@ static inline void basic_update_terminal_size(int &cols, int &rows) {
 }
 
 struct Interpreter {
+    // Declared first: its string heap owns the strings in `compiled` and `vm` too.
+    Env env;
+
     int termCols = 80;
     int termRows = 24;
     bool debugStepping = false;
 
+    // RUN engine. DEBUG always steps through the tree-walking Parser. TIERED starts
+    // each run on the Parser, which costs nothing up front, and moves it to the VM
+    // once the Parser has entered any one line hotLineThreshold times.
+    enum class Engine { Tree, VM, Tiered };
+    Engine engine = Engine::Tiered;
+    CompiledProgram compiled;
+    uint64_t compiledVersion = 0; // env.programVersion `compiled` was built from
+    VM vm;
+    Jit jit;            // used by the VM while JIT is ON; rebuilt whenever the program changes
+    bool vmRun = false; // the current (or CONT-able) run belongs to the VM
+    bool tierUp = false; // TIERED run still on the Parser, counting lines
+    std::vector<uint32_t> lineHits; // per line slot
+    uint32_t hotLineThreshold = 1000;
+
     template <typename T>
     static auto basic_dump_vars(T& e, int) -> decltype(e.dumpVars(std::cout), void()) {
         e.dumpVars(std::cout);
@@ -198,24 +264,34 @@ struct Interpreter {
         env.running = false;
         env.stopped = false;
         env.contAvailable = false;
-        env.posInLine = 0;
-        env.pc = env.program.end();
+        env.stmtInLine = 0;
+        env.pc = env.lines.size();
         // Program text changed: DATA cache is now stale.
         env.dataCacheBuilt = false;
         env.dataCache.clear();
         env.dataPtr = 0;
     }
 
-    void storeProgramLine(int ln, const std::string& restRaw) {
-        if (ln <= 0) return;
+    // False (and nothing stored) if `ln` is outside 1..Env::kMaxLineNumber.
+    bool storeProgramLine(int ln, const std::string& restRaw) {
+        if (!Env::validLineNumber(ln)) return false;
         std::string rest = trim(restRaw);
         if (rest.empty()) {
-            auto it = env.program.find(ln);
-            if (it != env.program.end()) env.program.erase(it);
+            env.eraseLine(ln);
         } else {
-            env.program[ln] = normalize_keywords_upper_preserve(rest);
+            ProgramLine& pl = env.storeLine(ln);
+            pl.text = normalize_keywords_upper_preserve(rest);
+            tokenize_program_line(pl, env);
         }
         resetAfterProgramEdit();
+        return true;
+    }
+
+    // Tokenize any lines stored without going through storeProgramLine (e.g. the editor).
+    void tokenizeProgram() {
+        for (auto& [ln, pl] : env.program) {
+            if (!pl.tokenized()) tokenize_program_line(pl, env);
+        }
     }
     
     void cmd_SAVE(const std::string& filename) {
@@ -224,8 +300,8 @@ struct Interpreter {
             std::cout << "Cannot open file for writing: " << filename << "\n";
             return;
         }
-        for (const auto& [ln, text] : env.program) {
-            out << ln << " " << text << "\n";
+        for (const auto& [ln, line] : env.program) {
+            out << ln << " " << line.text << "\n";
         }
         try {
             std::filesystem::path p = std::filesystem::absolute(filename);
@@ -235,16 +311,42 @@ struct Interpreter {
         }
     }
 
-    void cmd_LOAD(const std::string& filename) {
+    // COMPILE "file.cpp": translate the program to C++ that builds against runtime.h.
+    bool cmd_COMPILE(const std::string& filename) {
+        if (env.program.empty()) {
+            std::cout << "No program to compile\n";
+            return false;
+        }
+        std::ofstream out(filename);
+        if (!out) {
+            std::cout << "Cannot open file for writing: " << filename << "\n";
+            return false;
+        }
+        tokenizeProgram();
+        ensureCompiled();
+        Transpiler(env, compiled).write(out);
+        try {
+            std::filesystem::path p = std::filesystem::absolute(filename);
+            std::cout << "Compiled to: " << p.string() << "\n";
+        } catch (...) {
+            std::cout << "Compiled to: " << filename << "\n";
+        }
+        return true;
+    }
+
+    // False if the file cannot be opened or a line was rejected (the rest still loads).
+    bool cmd_LOAD(const std::string& filename, bool announce = true) {
         std::ifstream in(filename);
         if (!in) {
             std::cout << "Cannot open file for reading: " << filename << "\n";
-            return;
+            return false;
         }
 
         env.program.clear();
+        env.reindexProgram();
         resetAfterProgramEdit();
 
+        bool ok = true; // false once a line is rejected
         std::string line;
         while (std::getline(in, line)) {
             std::string t = trim(line);
@@ -256,19 +358,23 @@ struct Interpreter {
             std::istringstream iss(t);
             int ln = 0;
             iss >> ln;
-            if (ln <= 0) continue;
 
             std::string rest;
             std::getline(iss, rest);
             rest = trim(rest);
 
-            storeProgramLine(ln, rest);
+            if (!storeProgramLine(ln, rest)) {
+                std::cout << "Bad line number: " << t.substr(0, t.find_first_not_of("0123456789")) << "\n";
+                ok = false;
+            }
         }
         // After LOAD, show how many lines are in memory.
-        std::cout << "Loaded " << env.program.size() << " lines. ";
-        std::cout << "OK\n";
+        if (announce) {
+            std::cout << "Loaded " << env.program.size() << " lines. ";
+            std::cout << "OK\n";
+        }
+        return ok;
     }
-    Env env;
 
     void cmd_LIST(const std::string& args = "") {
         // LIST
@@ -343,7 +449,7 @@ struct Interpreter {
         for (; it != env.program.end(); ++it) {
             int ln = it->first;
             if (hasEnd && ln > end) break;
-            std::cout << ln << " " << it->second << "\n";
+            std::cout << ln << " " << it->second.text << "\n";
         }
     }
 
@@ -358,6 +464,40 @@ struct Interpreter {
         std::cout << "OK\n";
     }
 
+    // ENGINE [TIERED|VM|TREE]: select (or show) the engine used by RUN.
+    void cmd_ENGINE(const std::string& args) {
+        std::string a = upper_ascii(trim(args));
+        if (a == "VM") engine = Engine::VM;
+        else if (a == "TREE") engine = Engine::Tree;
+        else if (a == "TIERED") engine = Engine::Tiered;
+        else if (!a.empty()) {
+            std::cout << "ENGINE must be TIERED, VM or TREE\n";
+            return;
+        }
+        const char* names[] = {"TREE", "VM", "TIERED"};
+        std::cout << "Engine: " << names[static_cast<int>(engine)] << "\n";
+    }
+
+    // JIT [ON|OFF]: native code for numeric FOR loops run by the VM (TIERED or VM).
+    void cmd_JIT(const std::string& args) {
+        std::string a = upper_ascii(trim(args));
+        if (a == "ON") {
+            if (!setJit(true)) std::cout << "JIT is not available on this platform\n";
+        } else if (a == "OFF") {
+            setJit(false);
+        } else if (!a.empty()) {
+            std::cout << "JIT must be ON or OFF\n";
+            return;
+        }
+        std::cout << "JIT: " << (vm.jit ? "ON" : "OFF") << "\n";
+    }
+
+    bool setJit(bool on) {
+        if (on && !Jit::available()) return false;
+        vm.jit = on ? &jit : nullptr;
+        return true;
+    }
+
     void cmd_DELETE(int line) {
         storeProgramLine(line, "");
     }
@@ -367,11 +507,48 @@ struct Interpreter {
         env.clearVars();
         env.running = true;
         env.stopped = false;
-        env.pc = env.program.begin();
-        env.posInLine = 0;
+        env.pc = 0;
+        env.stmtInLine = 0;
         env.dataCacheBuilt = false;   // or env.rebuildDataCache(env.program);
         env.restoreData(0, env.program);
         basic_reset_run_event_control(env);
+
+        tokenizeProgram();
+        vmRun = (engine == Engine::VM && !debugStepping);
+        tierUp = (engine == Engine::Tiered && !debugStepping);
+        if (vmRun) {
+            ensureCompiled();
+            vm.reset();
+        }
+        if (tierUp) lineHits.assign(env.lines.size(), 0);
+    }
+
+    // Unchanged programs reuse their bytecode from the previous RUN or tier-up.
+    void ensureCompiled() {
+        if (compiledVersion != env.programVersion) {
+            Compiler(env, compiled).compileProgram();
+            compiledVersion = env.programVersion;
+        }
+    }
+
+    // Moves a TIERED run from the Parser to the VM at its current position. The
+    // bytecode covers the whole program because jump targets are absolute pcs; the
+    // Parser's FOR and GOSUB frames are translated to the matching resume pcs.
+    void promoteToVM() {
+        tierUp = false;
+        ensureCompiled();
+        vm.reset();
+        for (const Env::ForFrame& f : env.forStack) {
+            vm.forStack.push_back({f.var, f.sym, f.counter,
+                                   compiled.pcForStatement(f.returnSlot, f.returnStmt)});
+        }
+        for (const Env::GosubFrame& g : env.gosubStack) {
+            vm.gosubStack.push_back({compiled.pcForStatement(g.slot, g.stmt), g.isInterval, g.savedDataPtr});
+        }
+        env.forStack.clear();
+        env.gosubStack.clear();
+        vm.pc = compiled.pcForStatement(env.pc, env.stmtInLine);
+        vmRun = true;
     }
 
     void runFromStart() {
@@ -379,6 +556,23 @@ struct Interpreter {
         execute();
     }
 
+    // Headless batch run (basic --run prog.bas): LOAD and RUN with no SDL, no REPL and
+    // no LOAD banner. The exit status is 0 when the program ends (END, STOP or the last
+    // line) and 1 on a load failure, an error or Ctrl+C.
+    int runBatch(const std::string& filename) {
+        BatchOutput out;
+        env.screen.putChar = [&out](char c) { out.sputc(c); };
+        env.screen.write = [&out](std::string_view s) { out.sputn(s.data(), static_cast<std::streamsize>(s.size())); };
+        bool ok = cmd_LOAD(filename, false);
+        if (ok && !env.program.empty()) {
+            runFromStart();
+            ok = !env.contAvailable;
+        }
+        env.screen.putChar = nullptr;
+        env.screen.write = nullptr;
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     void startCont() {
         if (!env.contAvailable) {
             std::cout << "Cannot CONTINUE\n";
@@ -396,6 +590,10 @@ struct Interpreter {
     }
 
     void execute() {
+        if (vmRun) {
+            if (env.running && !env.stopped) (void)vm.run(env, compiled, g_sigint_requested);
+            return;
+        }
         while (env.running && !env.stopped) {
             // Ctrl+C breaks execution and returns to the REPL.
             if (g_sigint_requested.exchange(false, std::memory_order_relaxed)) {
@@ -409,7 +607,7 @@ struct Interpreter {
                 basic_update_terminal_size(termCols, termRows);
             }
 
-            if (env.pc == env.program.end()) {
+            if (env.pc >= env.lines.size()) {
                 env.running = false;
                 env.contAvailable = false;
                 break;
@@ -417,12 +615,13 @@ struct Interpreter {
 
             // DEBUG single-step: show current line + variables, then wait for SPACE/ESC.
             if (debugStepping) {
-                int ln = env.pc->first;
-                const std::string& full = env.pc->second;
+                int ln = env.lines[env.pc].number;
+                const ProgramLine& pl = *env.lines[env.pc].line;
+                const std::string& full = pl.text;
 
                 std::cout << "\n[DEBUG] Line " << ln << ": " << full << "\n";
-                if (env.posInLine > 0 && env.posInLine < static_cast<int>(full.size())) {
-                    std::cout << "[DEBUG] At: " << full.substr(static_cast<size_t>(env.posInLine)) << "\n";
+                if (env.stmtInLine > 0 && pl.tokenized() && pl.stmtOffset(env.stmtInLine) < full.size()) {
+                    std::cout << "[DEBUG] At: " << full.substr(pl.stmtOffset(env.stmtInLine)) << "\n";
                 }
                 std::cout << "[DEBUG] Variables:\n";
                 basic_dump_vars(env, 0);
@@ -438,29 +637,22 @@ struct Interpreter {
                 std::cout << "\n";
             }
 
-            int currentLineNumber = env.pc->first;
-            std::string lineText = env.pc->second;
-
-            std::string toParse;
-            if (env.posInLine > 0 && env.posInLine < lineText.size()) {
-                toParse = lineText.substr(env.posInLine);
-            } else {
-                env.posInLine = 0;
-                toParse = lineText;
+            if (tierUp && env.pc < lineHits.size() && ++lineHits[env.pc] >= hotLineThreshold) {
+                promoteToVM();
+                (void)vm.run(env, compiled, g_sigint_requested);
+                return;
             }
 
-            Parser p(toParse, env);
-            p.currentLine = lineText;
-            p.linePosBase = (env.posInLine);
+            const Env::LineRecord& cur = env.lines[env.pc];
+            int currentLineNumber = cur.number;
+            Parser p(*cur.line, env.stmtInLine, env);
 
             try {
-                p.parseAndExecLine();
-                env.pc++;
-                env.posInLine = 0;
-            } catch (const RuntimeError& e) {
-                if (std::string(e.what()) == "__JUMP__") {
-                    continue;
+                if (p.parseAndExecLine() == ExecStatus::Continue) {
+                    env.pc++;
+                    env.stmtInLine = 0;
                 }
+            } catch (const RuntimeError& e) {
                 std::cout << "Runtime error in " << currentLineNumber << ": " << e.what() << "\n";
                 env.running = false;
                 env.contAvailable = true;
@@ -479,12 +671,13 @@ struct Interpreter {
         g_sigint_requested.store(false, std::memory_order_relaxed);
         Parser p(line, env);
         try {
-            p.parseAndExecLine();
+            (void)p.parseAndExecLine();
         } catch (const std::exception& e) {
             std::cout << "Error: " << e.what() << "\n";
         }
     }
 
+#if BASIC_USE_SDL
     // SDL/TTF REPL rendering helpers moved out of header.
 
     static inline bool sdl_events_allowed_on_this_thread() {
@@ -539,10 +732,12 @@ struct Interpreter {
         }
         sdl_input_cv().notify_one();
     }
-    
+#endif
+
     static inline bool basic_getline_with_sdl_pump(std::string& outLine) {
         outLine.clear();
 
+#if BASIC_USE_SDL
         // If the SDL UI is active, consume input lines provided by the SDL thread.
         if (sdl_ui_active_flag().load(std::memory_order_relaxed)) {
             sdl_waiting_input_flag().store(true, std::memory_order_relaxed);
@@ -555,15 +750,18 @@ struct Interpreter {
             sdl_waiting_input_flag().store(false, std::memory_order_relaxed);
             return true;
         }
+#endif
 
         // Console mode: just block on stdin.
         return static_cast<bool>(std::getline(std::cin, outLine));
     }
 
+#if BASIC_USE_SDL
     void repl_sdl2_ttf();
+#endif
 
+    // Terminal REPL: the console-only build's front end, and the SDL one's fallback.
     void repl() {
-        // Tip: define BASIC_USE_SDL and call repl_sdl2_ttf() instead of repl() to run the graphics frontend.
         std::string line;
         std::deque<std::string> history; // command history (max 64)
         std::string historyDraft;        // what user was typing before history navigation
@@ -756,14 +954,10 @@ struct Interpreter {
                 std::istringstream iss(t);
                 int ln = 0;
                 iss >> ln;
-                if (ln <= 0) {
-                    std::cout << "Bad line number\n";
-                    continue;
-                }
                 std::string rest;
                 std::getline(iss, rest);
                 rest = trim(rest);
-                storeProgramLine(ln, rest);
+                if (!storeProgramLine(ln, rest)) std::cout << "Bad line number\n";
                 continue;
             }
 
@@ -786,6 +980,14 @@ struct Interpreter {
             if (upper == "NEW") { cmd_NEW(); continue; }
             if (upper == "CLEAR") { cmd_CLEAR(); continue; }
             if (upper == "CONT") { cont(); continue; }
+            if (istartswith(upper, "ENGINE")) {
+                cmd_ENGINE(t.substr(6));
+                continue;
+            }
+            if (upper == "JIT" || istartswith(upper, "JIT ")) {
+                cmd_JIT(t.substr(3));
+                continue;
+            }
             if (upper == "QUIT" || upper == "EXIT") {
                 std::cout << "Bye\n";
                 return; // exit REPL and terminate app
@@ -806,6 +1008,17 @@ struct Interpreter {
                 continue;
             }
 
+            if (istartswith(upper, "COMPILE")) {
+                std::string rest = trim(t.substr(7));
+                size_t endq = rest.empty() || rest[0] != '"' ? std::string::npos : rest.find('"', 1);
+                if (endq == std::string::npos) {
+                    std::cout << "COMPILE requires a filename in quotes\n";
+                    continue;
+                }
+                cmd_COMPILE(rest.substr(1, endq - 1));
+                continue;
+            }
+
             if (istartswith(upper, "LOAD")) {
                 std::string rest = trim(t.substr(4));
                 if (rest.empty() || rest[0] != '"') {
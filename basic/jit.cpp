@@ -0,0 +1,604 @@
+//
+//  jit.cpp
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+
+#include "jit.h"
+#include "builtins.h"
+#include "parser.h"
+#include "statements.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <unordered_map>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define BASIC_JIT 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define BASIC_JIT 0
+#endif
+
+namespace {
+
+constexpr size_t kJitStack = 32;
+constexpr size_t kJitRefs = 32;
+constexpr uint32_t kJitMaxBody = 4096; // instructions
+
+// Everything the native code touches besides the variables themselves. rbx holds its
+// address for the whole call; every operand stack depth has a fixed slot.
+struct JitFrame {
+    double stack[kJitStack];
+    void* refs[kJitRefs];     // payload of each variable, or of element 0 of each array
+    int32_t bounds[kJitRefs]; // element count of each array
+    const void* breakFlag;
+    double forEnd;
+    double forStep;
+    int32_t forIEnd;
+    int32_t forIStep;
+    int32_t loopDone;
+};
+
+using JitEntry = uint32_t (*)(JitFrame*);
+
+static_assert(sizeof(Value) == 16, "array element addressing assumes 16-byte Values");
+static_assert(sizeof(std::atomic<bool>) == 1, "the break flag is tested as a byte");
+
+double jit_sin(double x) { return std::sin(x); }
+double jit_cos(double x) { return std::cos(x); }
+double jit_tan(double x) { return std::tan(x); }
+double jit_atn(double x) { return std::atan(x); }
+double jit_log(double x) { return std::log(x); }
+double jit_exp(double x) { return std::exp(x); }
+double jit_sqr(double x) { return std::sqrt(x); }
+double jit_abs(double x) { return std::fabs(x); }
+double jit_int(double x) { return std::floor(x); }
+double jit_sgn(double x) { return x > 0 ? 1.0 : (x < 0 ? -1.0 : 0.0); }
+double jit_pow(double a, double b) { return std::pow(a, b); }
+
+// Same order as Builtin::SIN .. Builtin::SGN.
+double (*const kMathFns[])(double) = {
+    jit_sin, jit_cos, jit_tan, jit_atn, jit_log, jit_exp, jit_sqr, jit_abs, jit_int, jit_sgn
+};
+
+enum Reg : uint8_t { RAX = 0, RCX = 1, RDX = 2, RBX = 3 };
+
+// Machine-code templates. Memory operands are always [base + disp32] so every hole
+// has the same shape.
+struct Asm {
+    std::vector<uint8_t> b;
+
+    size_t pos() const { return b.size(); }
+    void put(std::initializer_list<uint8_t> bytes) { b.insert(b.end(), bytes); }
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) b.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void u64(uint64_t v) {
+        for (int i = 0; i < 8; ++i) b.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void mem(uint8_t reg, Reg base, int32_t disp) {
+        b.push_back(static_cast<uint8_t>(0x80 | (reg << 3) | base));
+        u32(static_cast<uint32_t>(disp));
+    }
+    void patch32(size_t at, int32_t v) {
+        for (int i = 0; i < 4; ++i) b[at + static_cast<size_t>(i)] = static_cast<uint8_t>(static_cast<uint32_t>(v) >> (8 * i));
+    }
+
+    void movsdLoad(uint8_t x, Reg base, int32_t disp) { put({0xF2, 0x0F, 0x10}); mem(x, base, disp); }
+    void movsdStore(uint8_t x, Reg base, int32_t disp) { put({0xF2, 0x0F, 0x11}); mem(x, base, disp); }
+    void sse(uint8_t opc, uint8_t x, Reg base, int32_t disp) { put({0xF2, 0x0F, opc}); mem(x, base, disp); }
+    void load64(Reg r, Reg base, int32_t disp) { put({0x48, 0x8B}); mem(r, base, disp); }
+    void store64(Reg r, Reg base, int32_t disp) { put({0x48, 0x89}); mem(r, base, disp); }
+    void imm64(Reg r, uint64_t v) { put({0x48, static_cast<uint8_t>(0xB8 + r)}); u64(v); }
+    void callRax() { put({0xFF, 0xD0}); }
+    // movsx eax, word [rax]; cvtsi2sd xmm0, eax
+    void loadInt16Rax() { put({0x0F, 0xBF, 0x00, 0xF2, 0x0F, 0x2A, 0xC0}); }
+    // setcc al from the flags left by ucomisd, then xmm0 = al ? 1.0 : 0.0
+    void boolToXmm0() { put({0x0F, 0xB6, 0xC0, 0xF2, 0x0F, 0x2A, 0xC0}); }
+    // jcc rel32 (cc = low nibble of 0F 8x); returns the offset of the hole
+    size_t jcc(uint8_t cc) { put({0x0F, static_cast<uint8_t>(0x80 | cc)}); u32(0); return pos() - 4; }
+    size_t jmp() { put({0xE9}); u32(0); return pos() - 4; }
+};
+
+constexpr uint8_t CC_E = 0x4, CC_NE = 0x5, CC_AE = 0x3, CC_A = 0x7, CC_GE = 0xD, CC_LE = 0xE;
+
+constexpr int32_t stackOff(size_t depth) { return static_cast<int32_t>(offsetof(JitFrame, stack) + 8 * depth); }
+constexpr int32_t refOff(size_t k) { return static_cast<int32_t>(offsetof(JitFrame, refs) + 8 * k); }
+constexpr int32_t boundOff(size_t k) { return static_cast<int32_t>(offsetof(JitFrame, bounds) + 4 * k); }
+
+enum class Tag : uint8_t { Int, Double };
+
+// Translates one loop body. Values on the operand stack are always held as doubles;
+// the tags say which of them the VM would have as int16, because int16 + - * must
+// stop at the int16 range where the VM raises Overflow.
+struct Translator {
+    Env& env;
+    const CompiledProgram& prog;
+    uint32_t head, last;
+    Asm a;
+    std::vector<Tag> tags;
+    uint32_t stmtPc = 0;                                 // where the VM re-runs from on deopt
+    std::vector<size_t> label;                           // code offset per pc in the body
+    std::vector<int> depthAt;                            // operand depth on entry, per pc
+    std::vector<std::pair<size_t, uint32_t>> jumps;      // (hole, pc in the body)
+    std::vector<std::pair<size_t, uint32_t>> exits;      // (hole, pc the VM resumes at)
+    std::vector<size_t> doneExits;                       // holes of "loop finished" exits
+    std::vector<std::pair<uint32_t, bool>> refKeys;      // (slot or name index, array)
+    std::vector<Env::VarType> refTypes;
+
+    Translator(Env& e, const CompiledProgram& p, uint32_t h, uint32_t l)
+        : env(e), prog(p), head(h), last(l), label(l - h + 1, 0), depthAt(l - h + 1, -1) {}
+
+    bool inBody(uint32_t pc) const { return pc >= head && pc <= last; }
+    size_t depth() const { return tags.size(); }
+
+    int ref(uint32_t id, bool array) {
+        for (size_t k = 0; k < refKeys.size(); ++k) {
+            if (refKeys[k].first == id && refKeys[k].second == array) return static_cast<int>(k);
+        }
+        if (refKeys.size() == kJitRefs) return -1;
+        Env::VarType t;
+        if (array) {
+            const std::string& nm = prog.names[id];
+            auto it = env.arrays.find(nm);
+            t = it != env.arrays.end() ? it->second.type : env.varTypeForName(nm);
+        } else {
+            const Env::VarSlot& s = env.vars[id];
+            t = s.bound ? s.type : env.varTypeForName(env.varNames[id]);
+        }
+        if (t == Env::VarType::String) return -1;
+        refKeys.push_back({id, array});
+        refTypes.push_back(t);
+        return static_cast<int>(refKeys.size() - 1);
+    }
+
+    void exitTo(size_t hole, uint32_t pc) { exits.push_back({hole, pc}); }
+    void branchTo(size_t hole, uint32_t pc) {
+        if (inBody(pc)) jumps.push_back({hole, pc});
+        else exitTo(hole, pc);
+    }
+
+    // ecx = xmm0 truncated toward zero, leaving for the VM unless it fits int16
+    // (Value::toInt16Checked).
+    void checkInt16Xmm0() {
+        a.put({0xF2, 0x0F, 0x2C, 0xC8});             // cvttsd2si ecx, xmm0
+        a.put({0x8D, 0x91}); a.u32(0x8000);          // lea edx, [rcx + 32768]
+        a.put({0x81, 0xFA}); a.u32(0xFFFF);          // cmp edx, 65535
+        exitTo(a.jcc(CC_A), stmtPc);
+    }
+    // The int16 result at the top of the stack: range checked, and -0 becomes 0.
+    void checkIntTop() {
+        a.movsdLoad(0, RBX, stackOff(depth() - 1));
+        checkInt16Xmm0();
+        a.put({0xF2, 0x0F, 0x2A, 0xC1});             // cvtsi2sd xmm0, ecx
+        a.movsdStore(0, RBX, stackOff(depth() - 1));
+    }
+
+    bool pushConst(int32_t k) {
+        const Value& v = prog.consts[static_cast<size_t>(k)];
+        if (!v.isNumber() || depth() == kJitStack) return false;
+        double d = v.asNumber();
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        a.imm64(RAX, bits);
+        a.store64(RAX, RBX, stackOff(depth()));
+        tags.push_back(v.isInt() ? Tag::Int : Tag::Double);
+        return true;
+    }
+
+    bool loadVar(uint32_t slot) {
+        int k = ref(slot, false);
+        if (k < 0 || depth() == kJitStack) return false;
+        a.load64(RAX, RBX, refOff(static_cast<size_t>(k)));
+        if (refTypes[static_cast<size_t>(k)] == Env::VarType::Int16) a.loadInt16Rax();
+        else a.movsdLoad(0, RAX, 0);
+        a.movsdStore(0, RBX, stackOff(depth()));
+        tags.push_back(refTypes[static_cast<size_t>(k)] == Env::VarType::Int16 ? Tag::Int : Tag::Double);
+        return true;
+    }
+
+    // Env::setVar's conversion: doubles as they are, int16 truncated and range checked.
+    bool storeVar(uint32_t slot) {
+        int k = ref(slot, false);
+        if (k < 0 || tags.empty()) return false;
+        a.movsdLoad(0, RBX, stackOff(depth() - 1));
+        if (refTypes[static_cast<size_t>(k)] == Env::VarType::Int16) {
+            checkInt16Xmm0();
+            a.load64(RAX, RBX, refOff(static_cast<size_t>(k)));
+            a.put({0x66, 0x89, 0x08});               // mov [rax], cx
+        } else {
+            a.load64(RAX, RBX, refOff(static_cast<size_t>(k)));
+            a.movsdStore(0, RAX, 0);
+        }
+        tags.pop_back();
+        return true;
+    }
+
+    // rax = address of the payload of element [stack[at]] of array k, or leave.
+    void elemAddress(int k, size_t at) {
+        a.movsdLoad(0, RBX, stackOff(at));
+        a.put({0xF2, 0x0F, 0x2C, 0xC0});             // cvttsd2si eax, xmm0
+        a.put({0x3B}); a.mem(RAX, RBX, boundOff(static_cast<size_t>(k))); // cmp eax, bound
+        exitTo(a.jcc(CC_AE), stmtPc);                // negative indexes wrap and fail too
+        a.put({0x48, 0xC1, 0xE0, 0x04});             // shl rax, 4
+        a.load64(RDX, RBX, refOff(static_cast<size_t>(k)));
+        a.put({0x48, 0x01, 0xD0});                   // add rax, rdx
+    }
+
+    bool loadElem(uint32_t nameIdx) {
+        int k = ref(nameIdx, true);
+        if (k < 0 || tags.empty()) return false;
+        elemAddress(k, depth() - 1);
+        bool isInt = refTypes[static_cast<size_t>(k)] == Env::VarType::Int16;
+        if (isInt) a.loadInt16Rax();
+        else a.movsdLoad(0, RAX, 0);
+        a.movsdStore(0, RBX, stackOff(depth() - 1));
+        tags.back() = isInt ? Tag::Int : Tag::Double;
+        return true;
+    }
+
+    bool storeElem(uint32_t nameIdx) {
+        int k = ref(nameIdx, true);
+        if (k < 0 || depth() < 2) return false;
+        elemAddress(k, depth() - 2);
+        a.movsdLoad(0, RBX, stackOff(depth() - 1));
+        if (refTypes[static_cast<size_t>(k)] == Env::VarType::Int16) {
+            checkInt16Xmm0();
+            a.put({0x66, 0x89, 0x08});               // mov [rax], cx
+        } else {
+            a.movsdStore(0, RAX, 0);
+        }
+        tags.resize(depth() - 2);
+        return true;
+    }
+
+    // lhs op rhs for the operators Parser::applyOp gives the same answer for in double.
+    bool binary(TokenKind op, bool intResultAllowed) {
+        if (depth() < 2) return false;
+        Tag rt = tags.back();
+        tags.pop_back();
+        Tag lt = tags.back();
+        int32_t lhs = stackOff(depth() - 1), rhs = stackOff(depth());
+        switch (op) {
+            case TokenKind::Plus:
+            case TokenKind::Minus:
+            case TokenKind::Star:
+            case TokenKind::Slash: {
+                uint8_t opc = op == TokenKind::Plus ? 0x58 : op == TokenKind::Minus ? 0x5C
+                            : op == TokenKind::Star ? 0x59 : 0x5E;
+                a.movsdLoad(0, RBX, lhs);
+                a.sse(opc, 0, RBX, rhs);
+                a.movsdStore(0, RBX, lhs);
+                bool isInt = intResultAllowed && op != TokenKind::Slash && lt == Tag::Int && rt == Tag::Int;
+                tags.back() = isInt ? Tag::Int : Tag::Double;
+                if (isInt) checkIntTop();
+                return true;
+            }
+            case TokenKind::Caret:
+                a.movsdLoad(0, RBX, lhs);
+                a.movsdLoad(1, RBX, rhs);
+                a.imm64(RAX, reinterpret_cast<uint64_t>(&jit_pow));
+                a.callRax();
+                a.movsdStore(0, RBX, lhs);
+                tags.back() = Tag::Double;
+                return true;
+            case TokenKind::Equal:
+            case TokenKind::NotEqual:
+            case TokenKind::Less:
+            case TokenKind::LessEqual:
+            case TokenKind::Greater:
+            case TokenKind::GreaterEqual: {
+                a.movsdLoad(0, RBX, lhs);
+                a.movsdLoad(1, RBX, rhs);
+                // Unordered (NaN) operands compare false except for <>.
+                switch (op) {
+                    case TokenKind::Equal:
+                        a.put({0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8}); break;
+                    case TokenKind::NotEqual:
+                        a.put({0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x95, 0xC0, 0x0F, 0x9A, 0xC1, 0x08, 0xC8}); break;
+                    case TokenKind::Less:
+                        a.put({0x66, 0x0F, 0x2E, 0xC8, 0x0F, 0x97, 0xC0}); break;  // rhs > lhs
+                    case TokenKind::LessEqual:
+                        a.put({0x66, 0x0F, 0x2E, 0xC8, 0x0F, 0x93, 0xC0}); break;  // rhs >= lhs
+                    case TokenKind::Greater:
+                        a.put({0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x97, 0xC0}); break;
+                    default:
+                        a.put({0x66, 0x0F, 0x2E, 0xC1, 0x0F, 0x93, 0xC0}); break;
+                }
+                a.boolToXmm0();
+                a.movsdStore(0, RBX, lhs);
+                tags.back() = Tag::Int;
+                return true;
+            }
+            default:
+                return false; // \ MOD AND OR keep their int16 semantics in the VM
+        }
+    }
+
+    // Pops the condition and jumps to `target` when it is 0 (NaN counts as true).
+    bool jumpIfFalse(uint32_t target) {
+        if (tags.empty()) return false;
+        a.movsdLoad(0, RBX, stackOff(depth() - 1));
+        tags.pop_back();
+        a.put({0x66, 0x0F, 0x57, 0xC9});             // xorpd xmm1, xmm1
+        a.put({0x66, 0x0F, 0x2E, 0xC1});             // ucomisd xmm0, xmm1
+        a.put({0x7A, 0x06});                         // jp over the je
+        branchTo(a.jcc(CC_E), target);
+        return true;
+    }
+
+    void breakCheck(uint32_t resumePc) {
+        a.load64(RAX, RBX, static_cast<int32_t>(offsetof(JitFrame, breakFlag)));
+        a.put({0x80, 0x38, 0x00});                   // cmp byte [rax], 0
+        exitTo(a.jcc(CC_NE), resumePc);
+    }
+
+    // NEXT for the loop being compiled: Env::stepFor's int16 or double path.
+    bool next(uint32_t var, bool intCounter, bool stepUp) {
+        int k = ref(var, false);
+        if (k < 0) return false;
+        // An int16 variable counting in double (fractional STEP) takes stepFor's general path.
+        if ((refTypes[static_cast<size_t>(k)] == Env::VarType::Int16) != intCounter) return false;
+        a.load64(RAX, RBX, refOff(static_cast<size_t>(k)));
+        size_t hole;
+        if (intCounter) {
+            a.put({0x0F, 0xBF, 0x08});               // movsx ecx, word [rax]
+            a.put({0x03}); a.mem(RCX, RBX, static_cast<int32_t>(offsetof(JitFrame, forIStep)));
+            a.put({0x8D, 0x91}); a.u32(0x8000);      // lea edx, [rcx + 32768]
+            a.put({0x81, 0xFA}); a.u32(0xFFFF);      // cmp edx, 65535
+            exitTo(a.jcc(CC_A), stmtPc);
+            a.put({0x66, 0x89, 0x08});               // mov [rax], cx
+            a.put({0x3B}); a.mem(RCX, RBX, static_cast<int32_t>(offsetof(JitFrame, forIEnd)));
+            hole = a.jcc(stepUp ? CC_LE : CC_GE);
+        } else {
+            a.movsdLoad(0, RAX, 0);
+            a.sse(0x58, 0, RBX, static_cast<int32_t>(offsetof(JitFrame, forStep)));
+            a.movsdStore(0, RAX, 0);
+            a.movsdLoad(1, RBX, static_cast<int32_t>(offsetof(JitFrame, forEnd)));
+            if (stepUp) a.put({0x66, 0x0F, 0x2E, 0xC8}); // ucomisd xmm1, xmm0: end >= cur
+            else a.put({0x66, 0x0F, 0x2E, 0xC1});        // ucomisd xmm0, xmm1: cur >= end
+            hole = a.jcc(CC_AE);
+        }
+        doneExits.push_back(a.jmp());
+        // Loop again: give Ctrl+C its chance, as VM::run does after NEXT.
+        a.patch32(hole, static_cast<int32_t>(a.pos() - (hole + 4)));
+        breakCheck(head);
+        jumps.push_back({a.jmp(), head});
+        return true;
+    }
+
+    bool op(uint32_t pc, uint32_t loopVar, bool intCounter, bool stepUp) {
+        const Instr& in = prog.code[pc];
+        switch (in.op) {
+            case Op::Line:
+                breakCheck(pc);
+                return true;
+            case Op::PushConst:
+                return pushConst(in.a);
+            case Op::LoadVar:
+                return loadVar(static_cast<uint32_t>(in.a));
+            case Op::StoreVar:
+                return storeVar(static_cast<uint32_t>(in.a));
+            case Op::StoreIntOp: {
+                // The VM only stays in int16 when the target is int16 too.
+                int k = ref(static_cast<uint32_t>(in.a), false);
+                if (k < 0) return false;
+                bool intTarget = refTypes[static_cast<size_t>(k)] == Env::VarType::Int16;
+                TokenKind bop = static_cast<TokenKind>(in.b);
+                if (bop != TokenKind::Plus && bop != TokenKind::Minus && bop != TokenKind::Star) return false;
+                return binary(bop, intTarget) && storeVar(static_cast<uint32_t>(in.a));
+            }
+            case Op::AddVarConst:
+                return loadVar(static_cast<uint32_t>(in.a)) && pushConst(in.b) &&
+                       binary((in.flag & 1) ? TokenKind::Minus : TokenKind::Plus, true) &&
+                       storeVar(static_cast<uint32_t>(in.a));
+            case Op::LoadElem:
+                return loadElem(static_cast<uint32_t>(in.a));
+            case Op::StoreElem:
+                return storeElem(static_cast<uint32_t>(in.a));
+            case Op::BinOp:
+            case Op::BinI:
+            case Op::BinN:
+                return binary(static_cast<TokenKind>(in.a), true);
+            case Op::Neg:
+                if (tags.empty()) return false;
+                a.imm64(RAX, 0x8000000000000000ull);
+                a.put({0x48, 0x31}); a.mem(RAX, RBX, stackOff(depth() - 1)); // xor [slot], rax
+                if (tags.back() == Tag::Int) checkIntTop();
+                return true;
+            case Op::Not:
+                if (tags.empty()) return false;
+                a.movsdLoad(0, RBX, stackOff(depth() - 1));
+                a.put({0x66, 0x0F, 0x57, 0xC9, 0x66, 0x0F, 0x2E, 0xC1});     // xorpd; ucomisd
+                a.put({0x0F, 0x94, 0xC0, 0x0F, 0x9B, 0xC1, 0x20, 0xC8});     // sete; setnp; and
+                a.boolToXmm0();
+                a.movsdStore(0, RBX, stackOff(depth() - 1));
+                tags.back() = Tag::Int;
+                return true;
+            case Op::Call: {
+                uint8_t id = static_cast<uint8_t>(in.a);
+                if (in.b != 1 || tags.empty() ||
+                    id < static_cast<uint8_t>(Builtin::SIN) || id > static_cast<uint8_t>(Builtin::SGN)) return false;
+                a.movsdLoad(0, RBX, stackOff(depth() - 1));
+                a.imm64(RAX, reinterpret_cast<uint64_t>(kMathFns[id - static_cast<uint8_t>(Builtin::SIN)]));
+                a.callRax();
+                a.movsdStore(0, RBX, stackOff(depth() - 1));
+                tags.back() = id == static_cast<uint8_t>(Builtin::SGN) ? Tag::Int : Tag::Double;
+                return true;
+            }
+            case Op::Jump:
+                branchTo(a.jmp(), static_cast<uint32_t>(in.a));
+                return true;
+            case Op::JumpIfFalse:
+                return jumpIfFalse(static_cast<uint32_t>(in.a));
+            case Op::IfVarConst:
+                // False steps over the Jump that follows.
+                return loadVar(static_cast<uint32_t>(in.a)) && pushConst(in.b) &&
+                       binary(static_cast<TokenKind>(in.flag), true) && jumpIfFalse(pc + 2);
+            case Op::Next:
+                return pc == last && next(loopVar, intCounter, stepUp);
+            default:
+                return false;
+        }
+    }
+
+    bool translate(uint32_t loopVar, bool intCounter, bool stepUp) {
+        a.put({0x53});                               // push rbx (also aligns rsp for calls)
+        a.put({0x48, 0x89, 0xFB});                   // mov rbx, rdi
+        for (uint32_t pc = head; pc <= last; ++pc) {
+            label[pc - head] = a.pos();
+            depthAt[pc - head] = static_cast<int>(depth());
+            if (tags.empty()) stmtPc = pc;
+            if (!op(pc, loopVar, intCounter, stepUp)) return false;
+        }
+        for (auto& [hole, pc] : jumps) {
+            if (depthAt[pc - head] != 0) return false;
+            a.patch32(hole, static_cast<int32_t>(label[pc - head] - (hole + 4)));
+        }
+        // One stub per resume pc: eax = pc; pop rbx; ret
+        std::unordered_map<uint32_t, size_t> stubs;
+        for (auto& [hole, pc] : exits) {
+            auto it = stubs.find(pc);
+            if (it == stubs.end()) {
+                it = stubs.emplace(pc, a.pos()).first;
+                a.put({0xB8}); a.u32(pc);
+                a.put({0x5B, 0xC3});
+            }
+            a.patch32(hole, static_cast<int32_t>(it->second - (hole + 4)));
+        }
+        size_t done = a.pos();
+        a.put({0xC7}); a.mem(0, RBX, static_cast<int32_t>(offsetof(JitFrame, loopDone))); a.u32(1);
+        a.put({0xB8}); a.u32(last + 1);
+        a.put({0x5B, 0xC3});
+        for (size_t hole : doneExits) a.patch32(hole, static_cast<int32_t>(done - (hole + 4)));
+        return true;
+    }
+};
+
+} // namespace
+
+bool Jit::available() {
+    return BASIC_JIT != 0;
+}
+
+void Jit::reset() {
+#if BASIC_JIT
+    for (Region& r : regions) {
+        if (r.code) munmap(r.code, r.mapped);
+    }
+#endif
+    regions.clear();
+    regionAt.clear();
+}
+
+bool Jit::compile(Env& env, const CompiledProgram& prog, uint32_t head, const VM::ForFrame& frame, Region& r) {
+#if BASIC_JIT
+    if (head == 0 || prog.code[head - 1].op != Op::ForInit) return false;
+    uint32_t sym = static_cast<uint32_t>(prog.code[head - 1].b);
+    if (sym != frame.sym || static_cast<uint32_t>(prog.code[head - 1].a) != frame.var) return false;
+
+    // The body ends at the first NEXT; a nested FOR means this is not an innermost loop.
+    uint32_t last = head;
+    while (last < prog.code.size() && last - head < kJitMaxBody) {
+        const Instr& in = prog.code[last];
+        if (in.op == Op::ForInit) return false;
+        if (in.op == Op::Next) break;
+        ++last;
+    }
+    if (last >= prog.code.size() || prog.code[last].op != Op::Next) return false;
+    const Instr& nx = prog.code[last];
+    if (nx.a >= 0 && static_cast<uint32_t>(nx.b) != sym) return false;
+
+    r.var = frame.var;
+    r.intCounter = frame.counter.isInt;
+    r.stepUp = frame.counter.isInt ? frame.counter.iStep >= 0 : frame.counter.step >= 0.0;
+
+    Translator t(env, prog, head, last);
+    if (!t.translate(frame.var, r.intCounter, r.stepUp)) return false;
+    for (size_t k = 0; k < t.refKeys.size(); ++k) {
+        r.refs.push_back({t.refKeys[k].first, t.refKeys[k].second, t.refTypes[k]});
+    }
+
+    // Written while writable, then flipped to executable: never both at once.
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t size = (t.a.b.size() + page - 1) / page * page;
+    void* mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) return false;
+    std::memcpy(mem, t.a.b.data(), t.a.b.size());
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        return false;
+    }
+    r.code = mem;
+    r.mapped = size;
+    return true;
+#else
+    (void)env; (void)prog; (void)head; (void)frame; (void)r;
+    return false;
+#endif
+}
+
+bool Jit::run(Env& env, const CompiledProgram& prog, VM& vm, const std::atomic<bool>& breakRequested) {
+#if BASIC_JIT
+    if (programVersion != env.programVersion || regionAt.size() != prog.code.size()) {
+        reset();
+        programVersion = env.programVersion;
+        regionAt.assign(prog.code.size(), -2);
+    }
+    uint32_t head = vm.pc;
+    if (vm.forStack.empty() || head >= regionAt.size()) return false;
+    const VM::ForFrame& f = vm.forStack.back();
+
+    if (regionAt[head] == -2) {
+        Region r;
+        if (compile(env, prog, head, f, r)) {
+            regionAt[head] = static_cast<int32_t>(regions.size());
+            regions.push_back(std::move(r));
+        } else {
+            regionAt[head] = -1;
+        }
+    }
+    if (regionAt[head] < 0) return false;
+    const Region& r = regions[static_cast<size_t>(regionAt[head])];
+
+    // The code was specialized for this loop's counter and these variable types.
+    if (f.var != r.var || f.counter.isInt != r.intCounter) return false;
+    bool stepUp = f.counter.isInt ? f.counter.iStep >= 0 : f.counter.step >= 0.0;
+    if (stepUp != r.stepUp) return false;
+    // ON INTERVAL handlers run from the VM's Line safe points.
+    if (basic_interval_active(env)) return false;
+
+    JitFrame fr;
+    for (size_t k = 0; k < r.refs.size(); ++k) {
+        const Ref& ref = r.refs[k];
+        if (ref.array) {
+            auto it = env.arrays.find(prog.names[ref.id]);
+            if (it == env.arrays.end() || it->second.type != ref.type || it->second.elems.empty()) return false;
+            fr.refs[k] = &it->second.elems[0].p;
+            fr.bounds[k] = static_cast<int32_t>(it->second.elems.size());
+        } else {
+            Env::VarSlot& s = env.vars[ref.id];
+            if (!s.bound || s.type != ref.type) return false;
+            fr.refs[k] = &s.value.p;
+        }
+    }
+    fr.breakFlag = &breakRequested;
+    fr.forEnd = f.counter.endValue;
+    fr.forStep = f.counter.step;
+    fr.forIEnd = f.counter.iEnd;
+    fr.forIStep = f.counter.iStep;
+    fr.loopDone = 0;
+
+    vm.pc = reinterpret_cast<JitEntry>(r.code)(&fr);
+    if (fr.loopDone) vm.forStack.pop_back();
+    return true;
+#else
+    (void)env; (void)prog; (void)vm; (void)breakRequested;
+    return false;
+#endif
+}
@@ -0,0 +1,62 @@
+//
+//  jit.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bytecode.h"
+
+// Opt-in native code for numeric loops (JIT ON, --jit). The body of an innermost
+// FOR loop, from the instruction after ForInit up to its NEXT, is translated once
+// from the bytecode into x86-64 by pasting fixed machine-code templates and patching
+// their holes (stack offsets, constants, jump targets). Only numeric scalars, DIM
+// arrays, LET/IF/GOTO within the line, arithmetic, comparisons and the pure math
+// builtins qualify; anything else leaves the loop to the VM.
+//
+// Native code never raises an error. When a value leaves int16 range, an index is out
+// of bounds, a variable's type no longer matches, or Ctrl+C is pending, it returns
+// the pc of the statement it was in and the VM re-runs that statement, which reports
+// the error (or Break) exactly as it always has. Strings are rejected when the body
+// is compiled, and the code is discarded whenever the program is edited.
+struct Jit {
+    Jit() = default;
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+    ~Jit() { reset(); }
+
+    // Native code is only generated for x86-64 with the System V calling convention.
+    static bool available();
+
+    // Called by NEXT after it jumps back to vm.pc. Runs the loop natively if it can,
+    // leaving vm.pc (and the FOR stack, if the loop finished) where the VM continues.
+    bool run(Env& env, const CompiledProgram& prog, VM& vm, const std::atomic<bool>& breakRequested);
+
+    void reset();
+
+private:
+    struct Ref {
+        uint32_t id;        // variable slot, or array name index
+        bool array;
+        Env::VarType type;  // Int16 or Double, checked on every entry
+    };
+    struct Region {
+        void* code = nullptr;
+        size_t mapped = 0;
+        uint32_t var = 0;   // control variable slot
+        bool intCounter = false;
+        bool stepUp = true;
+        std::vector<Ref> refs;
+    };
+
+    uint64_t programVersion = 0;
+    std::vector<int32_t> regionAt; // per pc: -2 not tried, -1 not compilable, else index
+    std::vector<Region> regions;
+
+    bool compile(Env& env, const CompiledProgram& prog, uint32_t head, const VM::ForFrame& frame, Region& r);
+};
@@ -11,25 +11,51 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <optional>
+#include <charconv>
 #include "env.h"
+#include "builtins.h"
 #include "token.h"
+#include "string.h"
 
 using std::string;
 using std::vector;
 
+// Lexes a line in place: tokens view the source text, numbers are converted with
+// from_chars, and nothing is allocated unless the line has a lexical error (or a
+// literal beyond the range of a double).
 struct Lexer {
-    std::string s;
+    std::string_view s;
     size_t i = 0;
     size_t tokenStart = 0;
     size_t tokenEnd = 0;
 
-    explicit Lexer(std::string src) : s(std::move(src)), i(0) {}
+    // Pre-tokenized mode: tokens come from a stored line instead of `s`.
+    // Offsets (i, tokenStart, tokenEnd) are then relative to the full line text.
+    const ProgramLine* line = nullptr;
+    size_t k = 0;
+
+    // `src` must outlive the lexer and every token it returns.
+    explicit Lexer(std::string_view src) : s(src), i(0) {}
+    Lexer(const ProgramLine& pl, size_t firstToken) : line(&pl), k(firstToken) {
+        i = tokenStart = tokenEnd = pl.tokens[k].start;
+    }
+
+    // Position the lexer at the end of the input (REM, END, or a consumed THEN-clause).
+    void skipToEnd() {
+        if (line) {
+            k = line->tokens.size() - 1;
+            i = line->text.size();
+        } else {
+            i = s.size();
+        }
+    }
 
     void skipSpace() {
         while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i]))) ++i;
     }
 
-    bool match(const std::string& kw) {
+    bool match(std::string_view kw) {
         size_t j = i;
         for (char c : kw) {
             if (j >= s.size() || std::tolower(static_cast<unsigned char>(s[j])) != std::tolower(static_cast<unsigned char>(c)))
@@ -41,34 +67,47 @@ struct Lexer {
         return true;
     }
 
+    // Token-stream mode only: the token the next call to next() returns, or nullptr.
+    const Token* peek() const {
+        return line ? &line->tokens[k] : nullptr;
+    }
+
     Token next() {
+        if (line) {
+            const Token& t = line->tokens[k];
+            if (k + 1 < line->tokens.size()) ++k;
+            else if (!line->lexError.empty()) throw ParseError(line->lexError);
+            tokenStart = t.start;
+            tokenEnd = i = t.end;
+            return t;
+        }
+
         skipSpace();
         tokenStart = i;
-        auto makeTok = [&](TokenKind k, const std::string& txt, double num)->Token {
+        auto makeTok = [&](TokenKind k, std::string_view txt = {}, double num = 0.0) -> Token {
             tokenEnd = i;
             return Token{k, txt, num};
         };
-        if (i >= s.size()) return makeTok(TokenKind::End, "", 0.0);
+        if (i >= s.size()) return makeTok(TokenKind::End);
 
         char c = s[i];
 
-        // String literal
+        // String literal: the body up to the closing quote, "" included as written.
         if (c == '\"') {
-            ++i;
-            std::string out;
+            size_t start = ++i;
             while (i < s.size()) {
-                char d = s[i++];
-                if (d == '\"') {
-                    if (i < s.size() && s[i] == '\"') { // doubled quote
-                        out.push_back('\"');
-                        ++i;
+                if (s[i] == '\"') {
+                    if (i + 1 < s.size() && s[i + 1] == '\"') { // doubled quote
+                        i += 2;
                         continue;
                     }
                     break;
                 }
-                out.push_back(d);
+                ++i;
             }
-            return makeTok(TokenKind::String, out, 0.0);
+            std::string_view body = s.substr(start, i - start);
+            if (i < s.size()) ++i;
+            return makeTok(TokenKind::String, body);
         }
 
         // Number (integer or float)
@@ -89,94 +128,98 @@ struct Lexer {
                 while (j < s.size() && std::isdigit(static_cast<unsigned char>(s[j]))) { any = true; ++j; }
                 if (any) i = j;
             }
-            double val = std::strtod(s.substr(start, i - start).c_str(), nullptr);
-            return makeTok(TokenKind::Number, "", val);
+            double val = 0.0;
+            if (std::from_chars(s.data() + start, s.data() + i, val).ec != std::errc()) {
+                // Out of double range: strtod's infinity or zero (only this case allocates).
+                val = std::strtod(std::string(s.substr(start, i - start)).c_str(), nullptr);
+            }
+            return makeTok(TokenKind::Number, {}, val);
         }
 
         // Identifier or keyword
         if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
             size_t start = i++;
             while (i < s.size() && (std::isalnum(static_cast<unsigned char>(s[i])) || s[i] == '_' || s[i] == '$')) ++i;
-            std::string ident = s.substr(start, i - start);
-            std::string upper;
-            upper.reserve(ident.size());
-            for (char ch : ident) upper.push_back(std::toupper(static_cast<unsigned char>(ch)));
-
-            auto kw = [&](const char* k, TokenKind kind)->std::optional<Token> {
-                if (upper == k) return Token{kind, ident, 0.0};
-                return std::nullopt;
-            };
-
-            if (auto t = kw("PRINT", TokenKind::KW_PRINT)) { tokenEnd = i; return *t; }
-            if (auto t = kw("LET", TokenKind::KW_LET)) { tokenEnd = i; return *t; }
-            if (auto t = kw("INPUT", TokenKind::KW_INPUT)) { tokenEnd = i; return *t; }
-            if (auto t = kw("IF", TokenKind::KW_IF)) { tokenEnd = i; return *t; }
-            if (auto t = kw("THEN", TokenKind::KW_THEN)) { tokenEnd = i; return *t; }
-            if (auto t = kw("GOTO", TokenKind::KW_GOTO)) { tokenEnd = i; return *t; }
-            if (auto t = kw("GOSUB", TokenKind::KW_GOSUB)) { tokenEnd = i; return *t; }
-            if (auto t = kw("RETURN", TokenKind::KW_RETURN)) { tokenEnd = i; return *t; }
-            if (auto t = kw("FOR", TokenKind::KW_FOR)) { tokenEnd = i; return *t; }
-            if (auto t = kw("TO", TokenKind::KW_TO)) { tokenEnd = i; return *t; }
-            if (auto t = kw("STEP", TokenKind::KW_STEP)) { tokenEnd = i; return *t; }
-            if (auto t = kw("NEXT", TokenKind::KW_NEXT)) { tokenEnd = i; return *t; }
-            if (auto t = kw("END", TokenKind::KW_END)) { tokenEnd = i; return *t; }
-            if (auto t = kw("STOP", TokenKind::KW_STOP)) { tokenEnd = i; return *t; }
-            if (auto t = kw("REM", TokenKind::KW_REM)) { tokenEnd = i; return *t; }
-            if (auto t = kw("DIM", TokenKind::KW_DIM)) { tokenEnd = i; return *t; }
-            if (auto t = kw("AND", TokenKind::KW_AND)) { tokenEnd = i; return *t; }
-            if (auto t = kw("OR", TokenKind::KW_OR)) { tokenEnd = i; return *t; }
-            if (auto t = kw("NOT", TokenKind::KW_NOT)) { tokenEnd = i; return *t; }
-            if (auto t = kw("MOD", TokenKind::KW_MOD)) { tokenEnd = i; return *t; }
-            if (auto t = kw("CLS", TokenKind::KW_CLS)) { tokenEnd = i; return *t; }
-            if (auto t = kw("LOCATE", TokenKind::KW_LOCATE)) { tokenEnd = i; return *t; }
-            if (auto t = kw("COLOR", TokenKind::KW_COLOR)) { tokenEnd = i; return *t; }
-            if (auto t = kw("ON", TokenKind::KW_ON)) { tokenEnd = i; return *t; }
-            if (auto t = kw("INTERVAL", TokenKind::KW_INTERVAL)) { tokenEnd = i; return *t; }
-            if (auto t = kw("OFF", TokenKind::KW_OFF)) { tokenEnd = i; return *t; }
-            if (auto t = kw("DEFINT", TokenKind::KW_DEFINT)) { tokenEnd = i; return *t; }
-            if (auto t = kw("KEY", TokenKind::KW_KEY)) { tokenEnd = i; return *t; }
-            if (auto t = kw("READ", TokenKind::KW_READ)) { tokenEnd = i; return *t; }
-            if (auto t = kw("DATA", TokenKind::KW_DATA)) { tokenEnd = i; return *t; }
-            if (auto t = kw("RESTORE", TokenKind::KW_RESTORE)) { tokenEnd = i; return *t; }
-            if (auto t = kw("RANDOMIZE", TokenKind::KW_RANDOMIZE)) { tokenEnd = i; return *t; }
-            if (auto t = kw("BEEP", TokenKind::KW_BEEP)) { tokenEnd = i; return *t; }
-            if (auto t = kw("RUN", TokenKind::KW_RUN)) { tokenEnd = i; return *t; }
-            if (auto t = kw("LIST", TokenKind::KW_LIST)) { tokenEnd = i; return *t; }
-            if (auto t = kw("NEW", TokenKind::KW_NEW)) { tokenEnd = i; return *t; }
-            if (auto t = kw("CLEAR", TokenKind::KW_CLEAR)) { tokenEnd = i; return *t; }
-            if (auto t = kw("DELETE", TokenKind::KW_DELETE)) { tokenEnd = i; return *t; }
-            if (auto t = kw("CONT", TokenKind::KW_CONT)) { tokenEnd = i; return *t; }
-            if (auto t = kw("SAVE", TokenKind::KW_SAVE)) { tokenEnd = i; return *t; }
-            if (auto t = kw("LOAD", TokenKind::KW_LOAD)) { tokenEnd = i; return *t; }
-
-            return makeTok(TokenKind::Identifier, ident, 0.0);
+            std::string_view ident = s.substr(start, i - start);
+            TokenKind kind = keyword_kind(ident);
+            return makeTok(kind, kind == TokenKind::Identifier ? ident : std::string_view());
         }
 
         // Two-char relational operators
-        if (c == '<' && i + 1 < s.size() && s[i+1] == '>') { i += 2; return makeTok(TokenKind::NotEqual, "<>", 0.0); }
-        if (c == '<' && i + 1 < s.size() && s[i+1] == '=') { i += 2; return makeTok(TokenKind::LessEqual, "<=", 0.0); }
-        if (c == '>' && i + 1 < s.size() && s[i+1] == '=') { i += 2; return makeTok(TokenKind::GreaterEqual, ">=", 0.0); }
+        if (c == '<' && i + 1 < s.size() && s[i+1] == '>') { i += 2; return makeTok(TokenKind::NotEqual); }
+        if (c == '<' && i + 1 < s.size() && s[i+1] == '=') { i += 2; return makeTok(TokenKind::LessEqual); }
+        if (c == '>' && i + 1 < s.size() && s[i+1] == '=') { i += 2; return makeTok(TokenKind::GreaterEqual); }
 
         // Single char tokens
         ++i;
         switch (c) {
-            case '+': return makeTok(TokenKind::Plus, "+", 0.0);
-            case '-': return makeTok(TokenKind::Minus, "-", 0.0);
-            case '*': return makeTok(TokenKind::Star, "*", 0.0);
-            case '/': return makeTok(TokenKind::Slash, "/", 0.0);
-            case '\\': return makeTok(TokenKind::Backslash, "\\", 0.0);
-            case '^': return makeTok(TokenKind::Caret, "^", 0.0);
-            case '(': return makeTok(TokenKind::LParen, "(", 0.0);
-            case ')': return makeTok(TokenKind::RParen, ")", 0.0);
-            case ',': return makeTok(TokenKind::Comma, ",", 0.0);
-            case ';': return makeTok(TokenKind::Semicolon, ";", 0.0);
-            case ':': return makeTok(TokenKind::Colon, ":", 0.0);
-            case '=': return makeTok(TokenKind::Equal, "=", 0.0);
-            case '<': return makeTok(TokenKind::Less, "<", 0.0);
-            case '>': return makeTok(TokenKind::Greater, ">", 0.0);
-            case '%': return makeTok(TokenKind::KW_MOD, "%", 0.0);
+            case '+': return makeTok(TokenKind::Plus);
+            case '-': return makeTok(TokenKind::Minus);
+            case '*': return makeTok(TokenKind::Star);
+            case '/': return makeTok(TokenKind::Slash);
+            case '\\': return makeTok(TokenKind::Backslash);
+            case '^': return makeTok(TokenKind::Caret);
+            case '(': return makeTok(TokenKind::LParen);
+            case ')': return makeTok(TokenKind::RParen);
+            case ',': return makeTok(TokenKind::Comma);
+            case ';': return makeTok(TokenKind::Semicolon);
+            case ':': return makeTok(TokenKind::Colon);
+            case '=': return makeTok(TokenKind::Equal);
+            case '<': return makeTok(TokenKind::Less);
+            case '>': return makeTok(TokenKind::Greater);
+            case '%': return makeTok(TokenKind::KW_MOD);
         }
 
         throw ParseError(std::string("Unexpected character: ") + c);
     }
 };
+
+// Tokenize a stored program line once, at entry. Identifiers are interned and scalar
+// variables bound to their slot, so the parser never has to upper-case or hash them
+// again. Builtins and arrays (a name before '(') get no slot; arrays go by name.
+// Lexing stops after REM (the comment text is never executed), and a lexer error is
+// deferred until execution reaches it.
+static inline void tokenize_program_line(ProgramLine& pl, Env& env) {
+    pl.tokens.clear();
+    pl.stmtStarts.assign(1, 0);
+    pl.lexError.clear();
+
+    Lexer lx(pl.text);
+    while (true) {
+        Token t;
+        try {
+            t = lx.next();
+        } catch (const ParseError& e) {
+            pl.lexError = e.what();
+            t = Token{TokenKind::End, {}, 0.0};
+            lx.tokenStart = lx.tokenEnd = lx.i - 1;
+        }
+        t.start = static_cast<uint32_t>(lx.tokenStart);
+        t.end = static_cast<uint32_t>(lx.tokenEnd);
+        if (t.kind == TokenKind::Identifier) {
+            std::string name(t.text);
+            t.sym = env.internSymbol(upper_ascii(name));
+            t.fn = builtin_id(t.text);
+        }
+        pl.tokens.push_back(std::move(t));
+
+        if (pl.tokens.back().kind == TokenKind::Colon) {
+            pl.stmtStarts.push_back(static_cast<uint32_t>(pl.tokens.size()));
+        }
+        if (pl.tokens.back().kind == TokenKind::End) break;
+        if (pl.tokens.back().kind == TokenKind::KW_REM) {
+            uint32_t n = static_cast<uint32_t>(pl.text.size());
+            Token end{TokenKind::End, {}, 0.0};
+            end.start = end.end = n;
+            pl.tokens.push_back(std::move(end));
+            break;
+        }
+    }
+
+    for (size_t k = 0; k + 1 < pl.tokens.size(); ++k) {
+        Token& t = pl.tokens[k];
+        if (t.kind == TokenKind::Identifier && t.fn == 0 && pl.tokens[k + 1].kind != TokenKind::LParen) {
+            t.var = env.varSlot(std::string(t.text));
+        }
+    }
+}
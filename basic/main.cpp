@@ -4,8 +4,6 @@
 //
 //  Created by Emidio Cunha on 24/12/2025.
 //
-#define BASIC_USE_SDL 1
-
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -32,14 +30,46 @@ int main(int argc, const char * argv[]) {
 
     // Optional: auto LOAD+RUN a program file passed on the command line.
     // Example: ./basic demo.bas
-    if (argc >= 2 && argv[1] && argv[1][0] != '\0') {
-        std::string filename = argv[1];
+    //          ./basic --engine=tree demo.bas
+    //          ./basic --jit demo.bas
+    //          ./basic --compile=demo.cpp demo.bas   (translate to C++ and exit)
+    //          ./basic --run demo.bas                (headless: no window, exit status)
+    std::string filename;
+    std::string compileTo;
+    bool batch = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!argv[i] || argv[i][0] == '\0') continue;
+        std::string arg = argv[i];
+        if (arg == "--engine=tree") { interp.engine = Interpreter::Engine::Tree; continue; }
+        if (arg == "--engine=vm") { interp.engine = Interpreter::Engine::VM; continue; }
+        if (arg == "--engine=tiered") { interp.engine = Interpreter::Engine::Tiered; continue; }
+        if (arg == "--jit") { interp.setJit(true); continue; }
+        if (arg.rfind("--compile=", 0) == 0) { compileTo = arg.substr(10); continue; }
+        if (arg == "--run") { batch = true; continue; }
+        filename = arg;
+    }
+    if (batch) {
+        if (filename.empty()) {
+            std::cerr << "usage: basic --run [--engine=tree|vm|tiered] [--jit] program.bas\n";
+            return EXIT_FAILURE;
+        }
+        return interp.runBatch(filename);
+    }
+    if (!compileTo.empty()) {
+        if (!filename.empty()) interp.cmd_LOAD(filename);
+        return interp.cmd_COMPILE(compileTo) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if (!filename.empty()) {
         interp.cmd_LOAD(filename);
         if (!interp.env.program.empty()) {
             interp.runFromStart();
         }
     }
 
+#if BASIC_USE_SDL
     interp.repl_sdl2_ttf();
+#else
+    interp.repl();
+#endif
     return EXIT_SUCCESS;
 }
@@ -7,20 +7,16 @@
 
 #include "parser.h"
 #include "interpreter.h"
-
-// Small shim used by TAB() to call the helper (keeps Parser::callFunction earlier clean)
-void __basic_tab_side_effect(Env& env, int col1based) {
-    basic_print_tab_to_column1(env, col1based);
-}
+#include "statements.h"
 
 // -------------------- Parser statement execution --------------------
 
-void Parser::jumpToLine(int target) {
-    auto it = env.program.find(target);
-    if (it == env.program.end()) throw RuntimeError("Undefined line number");
-    env.pc = it;
-    env.posInLine = 0;
-    throw RuntimeError("__JUMP__");
+ExecStatus Parser::jumpToLine(int target) {
+    int32_t slot = env.slotFor(target);
+    if (slot < 0) throw RuntimeError("Undefined line number");
+    env.pc = static_cast<size_t>(slot);
+    env.stmtInLine = 0;
+    return ExecStatus::Jump;
 }
 
 void Parser::exec_PRINT() {
@@ -46,7 +42,7 @@ void Parser::exec_PRINT() {
         }
 
         Value v = parseExpression();
-        basic_print_string(env, v.asString());
+        basic_print_value(env, v);
 
         if (tok.kind == TokenKind::Comma) {
             basic_print_tab_to_next_stop(env);
@@ -74,7 +70,8 @@ void Parser::exec_LET_or_ASSIGN() {
     (void)hadLet;
 
     if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
-    std::string name = tok.text;
+    std::string_view name = tok.text;
+    Token target = tok;
     tok = lex.next();
 
     bool isArray = false;
@@ -85,25 +82,63 @@ void Parser::exec_LET_or_ASSIGN() {
         idx = static_cast<int>(args[0].asNumber());
         isArray = true;
     }
+    uint32_t slot = isArray ? 0 : varSlotOf(target);
 
     consume(TokenKind::Equal, "'='");
+
+    if (!isArray && isSelfAppend(slot, name)) {
+        exec_SELF_APPEND(slot);
+        return;
+    }
+
     Value rhs = parseExpression();
 
-    if (isArray) env.setArrayElem(name, idx, rhs);
-    else env.setVar(name, rhs);
+    if (isArray) env.setArrayElem(std::string(name), idx, rhs);
+    else env.setVar(slot, rhs);
+}
+
+// S$ = S$ + ... on a stored line (the right-hand side starts with the target itself).
+bool Parser::isSelfAppend(uint32_t slot, std::string_view name) const {
+    if (name.empty() || name.back() != '$') return false;
+    if (tok.kind != TokenKind::Identifier || tok.var != slot) return false;
+    const Token* next = lex.peek();
+    return next && next->kind == TokenKind::Plus;
+}
+
+void Parser::exec_SELF_APPEND(uint32_t slot) {
+    // Evaluate every "+ term" first, in the usual left-to-right order.
+    Value cur = parsePrimary();
+    std::vector<Value> pieces;
+    const int plusPrec = precedence(TokenKind::Plus);
+    while (tok.kind == TokenKind::Plus) {
+        tok = lex.next();
+        Value rhs = parsePrimary();
+        pieces.push_back(parseBinOpRHS(plusPrec + 1, rhs));
+    }
+
+    if (tok.kind == TokenKind::End || tok.kind == TokenKind::Colon) {
+        cur = Value(); // drop our reference so the variable's buffer is not shared
+        for (const Value& piece : pieces) env.appendToVar(slot, piece.asString());
+        return;
+    }
+
+    // Something of lower precedence follows (e.g. a comparison): evaluate normally.
+    for (const Value& piece : pieces) cur = applyOp(cur, TokenKind::Plus, piece);
+    env.setVar(slot, parseBinOpRHS(1, cur));
 }
 
 void Parser::exec_INPUT() {
     std::string prompt;
     if (tok.kind == TokenKind::String) {
-        prompt = tok.text;
+        prompt = tok.str();
         tok = lex.next();
         if (tok.kind == TokenKind::Semicolon || tok.kind == TokenKind::Comma) tok = lex.next();
     }
 
     while (true) {
         if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
-        std::string name = tok.text;
+        std::string name(tok.text);
+        Token target = tok;
         tok = lex.next();
 
         bool isArray = false;
@@ -114,31 +149,10 @@ void Parser::exec_INPUT() {
             idx = static_cast<int>(args[0].asNumber());
             isArray = true;
         }
+        uint32_t slot = isArray ? 0 : varSlotOf(target);
 
-        if (!prompt.empty()) basic_print_string(env, prompt);
-        else basic_print_string(env, "? ");
-
-        std::string line;
-        if (!Interpreter::basic_getline_with_sdl_pump(line)) {
-            throw RuntimeError("Input aborted");
-        }
-        line = trim(line);
-        // INPUT is line-oriented; once user submits, BASIC typically continues on the next line.
-        // Keep output consistent for SDL by ending the prompt line.
-        basic_print_char(env, '\n');
-
-        Value v;
-        if (!name.empty() && name.back() == '$') {
-            v = Value(line);
-        } else {
-            char* end = nullptr;
-            double d = std::strtod(line.c_str(), &end);
-            if (end == line.c_str()) d = 0.0;
-            v = Value(d);
-        }
-
-        if (isArray) env.setArrayElem(name, idx, v);
-        else env.setVar(name, v);
+        Value v = basic_input_value(env, prompt, name, Interpreter::basic_getline_with_sdl_pump);
+        basic_assign(env, name, isArray, slot, idx, v);
 
         if (tok.kind == TokenKind::Comma) {
             tok = lex.next();
@@ -148,183 +162,103 @@ void Parser::exec_INPUT() {
     }
 }
 
-void Parser::exec_GOTO(bool isGosub) {
+ExecStatus Parser::exec_GOTO(bool isGosub) {
     if (tok.kind != TokenKind::Number) throw ParseError("Expected line number");
     int target = static_cast<int>(tok.number);
     tok = lex.next();
 
     if (isGosub) {
         markLineProgress();
-        env.gosubStack.push_back({env.pc, env.posInLine, false, 0});
+        env.gosubStack.push_back({env.pc, env.stmtInLine, false, 0});
     }
 
-    jumpToLine(target);
+    return jumpToLine(target);
 }
 
-void Parser::exec_RETURN() {
-    if (env.gosubStack.empty()) throw RuntimeError("RETURN without GOSUB");
-
-    Env::GosubFrame fr = env.gosubStack.back();
-    env.gosubStack.pop_back();
-
-    env.pc = fr.it;
-    env.posInLine = fr.pos;
-
-    // Clear ISR flag only when returning from the ON INTERVAL handler frame.
-    if (fr.isInterval) {
-        // Restore DATA/READ position to what it was when the interval interrupted.
-        env.dataPtr = fr.savedDataPtr;
-        env.inIntervalISR = false;
-    }
-
-    throw RuntimeError("__JUMP__");
+ExecStatus Parser::exec_RETURN() {
+    Env::GosubFrame fr = basic_return(env, env.gosubStack);
+    env.pc = fr.slot;
+    env.stmtInLine = fr.stmt;
+    return ExecStatus::Jump;
 }
 
-void Parser::exec_IF() {
+ExecStatus Parser::exec_IF() {
     Value cond = parseExpression();
     consume(TokenKind::KW_THEN, "THEN");
-    // Remember where the first token after THEN begins.
-    size_t thenStmtStart = lex.tokenStart;
 
     bool truthy = (cond.asNumber() != 0.0);
     if (!truthy) {
         // In BASIC, ':' after THEN is still part of the THEN-clause.
         // If the condition is false, skip the entire remainder of the line.
         while (tok.kind != TokenKind::End) tok = lex.next();
-        return;
+        return ExecStatus::Continue;
     }
 
     if (tok.kind == TokenKind::Number) {
         int target = static_cast<int>(tok.number);
         tok = lex.next();
-        jumpToLine(target);
-    }
-
-    std::string rest = lex.s.substr(thenStmtStart);
-    if (!rest.empty()) {
-        Parser p2(rest, env);
-        p2.currentLine = currentLine;
-        p2.linePosBase = linePosBase + thenStmtStart;
-        while (p2.tok.kind != TokenKind::End) {
-            p2.execOneStatement();
-            if (p2.tok.kind == TokenKind::Colon) {
-                p2.tok = p2.lex.next();
-                continue;
-            }
-            break;
-        }
-        tok = Token{TokenKind::End, "", 0.0};
-        lex.i = lex.s.size();
+        return jumpToLine(target);
     }
+
+    // The THEN-clause is the rest of this line, so it runs right here on the same
+    // lexer: its offsets (and so every resume position) are already the line's own.
+    ExecStatus st = execStatements();
+    skipRestOfLine();
+    return st;
 }
 
 void Parser::exec_FOR() {
     if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
-    std::string var = tok.text;
+    uint32_t sym = symbolOf(tok);
+    uint32_t slot = varSlotOf(tok);
     tok = lex.next();
     consume(TokenKind::Equal, "'='");
     double start = parseExpression().asNumber();
     consume(TokenKind::KW_TO, "TO");
     double end = parseExpression().asNumber();
     double step = 1.0;
-    if (accept(TokenKind::KW_STEP)) {
-        step = parseExpression().asNumber();
-        if (step == 0.0) throw RuntimeError("STEP cannot be 0");
-    }
+    bool hasStep = accept(TokenKind::KW_STEP);
+    if (hasStep) step = parseExpression().asNumber();
 
-    env.setVar(var, Value(start));
+    Env::ForFrame frame;
+    frame.sym = sym;
+    frame.var = slot;
+    frame.counter = basic_for_start(env, slot, start, end, step, hasStep);
 
+    // The body starts at the next statement: inline after ':' or on the next line.
+    // Leave tok as ':' so the outer loop advances and runs an inline body.
     markLineProgress();
-    auto resumeIt = env.pc;
-    size_t resumePos = env.posInLine;
+    size_t resumeSlot = env.pc;
+    size_t resumeStmt = env.stmtInLine;
 
     if (tok.kind == TokenKind::End) {
-        auto it2 = env.pc;
-        if (it2 != env.program.end()) ++it2;
-        resumeIt = it2;
-        resumePos = 0;
-    } else if (tok.kind == TokenKind::Colon) {
-        // FOR with an inline body on the same line.
-        // IMPORTANT: do NOT consume the ':' here. `parseAndExecLine()` uses ':' as the
-        // statement separator; if we advance past it, the rest of the line won't run.
-        resumeIt = env.pc;
-        // Resume after ':' (tokenEnd points to the character just after ':').
-        resumePos = linePosBase + lex.tokenEnd;
-        // Leave tok as ':' so the outer loop can advance and execute the inline body.
+        if (resumeSlot < env.lines.size()) ++resumeSlot;
+        resumeStmt = 0;
     }
 
-    Env::ForFrame frame;
-    frame.var = var;
-    frame.endValue = end;
-    frame.step = step;
-    frame.returnIt = resumeIt;
-    frame.posInLine = resumePos;
-    
-    // GW-BASIC semantics: remove any existing FOR with same control variable (case-insensitive)
-    const std::string uvar = upperName(var);
-    for (int i = static_cast<int>(env.forStack.size()) - 1; i >= 0; --i) {
-        if (upperName(env.forStack[static_cast<size_t>(i)].var) == uvar) {
-            env.forStack.erase(env.forStack.begin() + i, env.forStack.end());
-            break;
-        }
-    }
-    
-    env.forStack.push_back(std::move(frame));
+    frame.returnSlot = resumeSlot;
+    frame.returnStmt = resumeStmt;
+    basic_push_for(env.forStack, frame);
 }
 
-void Parser::exec_NEXT() {
-    std::string var;
+ExecStatus Parser::exec_NEXT() {
+    uint32_t sym = 0;
     if (tok.kind == TokenKind::Identifier) {
-        var = tok.text;
+        sym = symbolOf(tok);
         tok = lex.next();
     }
-    if (env.forStack.empty()) {
-        throw RuntimeError("NEXT without FOR");
+    if (const Env::ForFrame* frame = basic_next(env, env.forStack, sym)) {
+        env.pc = frame->returnSlot;
+        env.stmtInLine = frame->returnStmt;
+        return ExecStatus::Jump;
     }
-
-    int idxFrame = static_cast<int>(env.forStack.size()) - 1;
-
-    // If NEXT specifies a variable, find the most recent FOR for that variable.
-    // BASIC is case-insensitive.
-    if (!var.empty()) {
-        const std::string uvar = upperName(var);
-        bool found = false;
-        for (int i = idxFrame; i >= 0; --i) {
-            if (upperName(env.forStack[static_cast<size_t>(i)].var) == uvar) {
-                idxFrame = i;
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            throw RuntimeError("NEXT without FOR");
-        }
-
-        // Drop any inner FORs above the matched one (GOTO can jump out of inner loops).
-        if (idxFrame + 1 < static_cast<int>(env.forStack.size())) {
-            env.forStack.erase(env.forStack.begin() + (idxFrame + 1), env.forStack.end());
-        }
-    }
-
-    Env::ForFrame &frame = env.forStack.back();
-    double cur = env.getVar(frame.var).asNumber();
-    cur += frame.step;
-    env.setVar(frame.var, Value(cur));
-
-    bool cont = (frame.step >= 0.0) ? (cur <= frame.endValue) : (cur >= frame.endValue);
-    if (cont) {
-        env.pc = frame.returnIt;
-        env.posInLine = frame.posInLine;
-        throw RuntimeError("__JUMP__");
-    }
-
-    env.forStack.pop_back();
+    return ExecStatus::Continue;
 }
 
 void Parser::exec_DIM() {
     while (true) {
         if (tok.kind != TokenKind::Identifier) throw ParseError("Expected array name");
-        std::string name = tok.text;
+        std::string name(tok.text);
         tok = lex.next();
         consume(TokenKind::LParen, "'('");
         Value v = parseExpression();
@@ -368,22 +302,12 @@ void Parser::exec_ON() {
         ticks = parseExpression().asNumber();
     }
 
-    // Convert ticks (1/60s) -> seconds
-    env.intervalSeconds = ticks / 60.0;
-
     consume(TokenKind::KW_GOSUB, "GOSUB");
     if (tok.kind != TokenKind::Number) throw ParseError("Expected line number");
-    env.intervalGosubLine = static_cast<int>(tok.number);
+    int gosubLine = static_cast<int>(tok.number);
     tok = lex.next();
 
-    // Arm the interval, but keep enabled state as-is; INTERVAL ON/OFF controls it.
-    env.intervalArmed = true;
-
-    // Initialize schedule so it can fire starting now + period.
-    auto now = std::chrono::steady_clock::now();
-    env.nextIntervalFire = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-        std::chrono::duration<double>(std::max(0.0, env.intervalSeconds))
-    );
+    basic_on_interval(env, ticks, gosubLine);
 }
 
 void Parser::exec_INTERVAL_CTRL() {
@@ -392,166 +316,161 @@ void Parser::exec_INTERVAL_CTRL() {
     // - OFF: disable timer (keeps settings)
     // - STOP: disable and disarm
 
-    if (tok.kind == TokenKind::KW_ON) {
-        tok = lex.next();
-        env.intervalEnabled = true;
-        if (env.intervalArmed && env.intervalSeconds > 0.0) {
-            auto now = std::chrono::steady_clock::now();
-            env.nextIntervalFire = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
-                std::chrono::duration<double>(env.intervalSeconds)
-            );
-        }
-        return;
-    }
-
-    if (tok.kind == TokenKind::KW_OFF) {
-        tok = lex.next();
-        env.intervalEnabled = false;
-        return;
-    }
-
-    if (tok.kind == TokenKind::KW_STOP) {
-        tok = lex.next();
-        env.intervalEnabled = false;
-        env.intervalArmed = false;
-        return;
-    }
-
-    throw RuntimeError("Expected INTERVAL ON/OFF/STOP");
+    int mode;
+    if (tok.kind == TokenKind::KW_ON) mode = 0;
+    else if (tok.kind == TokenKind::KW_OFF) mode = 1;
+    else if (tok.kind == TokenKind::KW_STOP) mode = 2;
+    else throw RuntimeError("Expected INTERVAL ON/OFF/STOP");
+    tok = lex.next();
+    basic_interval_ctl(env, mode);
 }
 
-void Parser::execOneStatement() {
-    if (tok.kind == TokenKind::End || tok.kind == TokenKind::Colon) return;
+ExecStatus Parser::execOneStatement() {
+    if (tok.kind == TokenKind::End || tok.kind == TokenKind::Colon) return ExecStatus::Continue;
 
     if (tok.kind == TokenKind::KW_REM) {
-        tok = Token{TokenKind::End, "", 0.0};
-        lex.i = lex.s.size();
-        return;
+        skipRestOfLine();
+        return ExecStatus::Continue;
     }
 
     switch (tok.kind) {
         case TokenKind::KW_ON:
             tok = lex.next();
             exec_ON();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_PRINT:
             tok = lex.next();
             exec_PRINT();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_INPUT:
             tok = lex.next();
             exec_INPUT();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_IF:
             tok = lex.next();
-            exec_IF();
-            return;
+            return exec_IF();
         case TokenKind::KW_GOTO:
             tok = lex.next();
-            exec_GOTO(false);
-            return;
+            return exec_GOTO(false);
         case TokenKind::KW_GOSUB:
             tok = lex.next();
-            exec_GOTO(true);
-            return;
+            return exec_GOTO(true);
         case TokenKind::KW_RETURN:
             tok = lex.next();
-            exec_RETURN();
-            return;
+            return exec_RETURN();
         case TokenKind::KW_FOR:
             tok = lex.next();
             exec_FOR();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_NEXT:
             tok = lex.next();
-            exec_NEXT();
-            return;
+            return exec_NEXT();
         case TokenKind::KW_DIM:
             tok = lex.next();
             exec_DIM();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_COLOR:
             tok = lex.next();
             exec_COLOR();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_BEEP:
             tok = lex.next();
             exec_BEEP();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_INTERVAL:
             tok = lex.next();
             exec_INTERVAL_CTRL();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_CLS:
             tok = lex.next();
-            if (env.screen.cls) env.screen.cls();
-            env.printCol = 0;
-            return;
+            basic_cls(env);
+            return ExecStatus::Continue;
         case TokenKind::KW_LOCATE:
             tok = lex.next();
             exec_LOCATE();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_RANDOMIZE:
             tok = lex.next();
             exec_RANDOMIZE();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_DEFINT:
             tok = lex.next();
             exec_DEFINT();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_KEY:
             tok = lex.next();
             exec_KEY_CTRL();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_CLEAR:
             tok = lex.next();
             exec_CLEAR();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_END:
         case TokenKind::KW_STOP:
             env.running = false;
             env.contAvailable = false;
-            tok = Token{TokenKind::End, "", 0.0};
-            lex.i = lex.s.size();
-            return;
+            skipRestOfLine();
+            return ExecStatus::Stop;
         case TokenKind::KW_LET:
             exec_LET_or_ASSIGN();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_DATA:
             tok = lex.next();
             exec_DATA();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_READ:
             tok = lex.next();
             exec_READ();
-            return;
+            return ExecStatus::Continue;
         case TokenKind::KW_RESTORE:
             tok = lex.next();
             exec_RESTORE();
-            return;
+            return ExecStatus::Continue;
         default:
             break;
     }
 
     if (tok.kind == TokenKind::Identifier) {
         exec_LET_or_ASSIGN();
-        return;
+        return ExecStatus::Continue;
     }
 
     (void)parseExpression();
+    return ExecStatus::Continue;
 }
 
-void Parser::parseAndExecLine() {
+// Runs ':'-separated statements up to the end of the line or the first one that
+// leaves it.
+ExecStatus Parser::execStatements() {
     while (tok.kind != TokenKind::End) {
-        execOneStatement();
+        ExecStatus st = execOneStatement();
+        if (st != ExecStatus::Continue) return st;
         if (tok.kind == TokenKind::Colon) {
             tok = lex.next();
+            ++stmt;
             continue;
         }
         break;
     }
+    return ExecStatus::Continue;
+}
+
+ExecStatus Parser::parseAndExecLine() {
+    ExecStatus st = execStatements();
+    if (st != ExecStatus::Continue) return st;
     // Interval safe-point between lines
-    maybeFireIntervalInterrupt();
+    return maybeFireIntervalInterrupt();
+}
+
+ExecStatus Parser::maybeFireIntervalInterrupt() {
+    if (!basic_interval_due(env)) return ExecStatus::Continue;
+
+    // Fire ONLY between lines: resume at the start of the NEXT line after RETURN.
+    size_t retSlot = env.pc;
+    if (retSlot < env.lines.size()) ++retSlot;
+
+    env.gosubStack.push_back({retSlot, 0, true, env.dataPtr});
+    return jumpToLine(env.intervalGosubLine);
 }
 
 void Parser::exec_LOCATE() {
@@ -580,17 +499,7 @@ void Parser::exec_LOCATE() {
         }
     }
 
-    if (row < 1) row = 1;
-    if (col < 1) col = 1;
-
-    if (cursor == 0) {
-        if (env.screen.showCursor) env.screen.showCursor(false);
-    } else if (cursor == 1) {
-        if (env.screen.showCursor) env.screen.showCursor(true);
-    }
-
-    if (env.screen.locate) env.screen.locate(row, col);
-    env.printCol = col - 1;
+    basic_locate(env, row, col, cursor);
 }
 
 void Parser::exec_COLOR() {
@@ -613,37 +522,17 @@ void Parser::exec_COLOR() {
         }
     }
 
-    // Apply via screen driver (SDL) if present.
-    if (env.screen.color) {
-        // Clamp to GW-BASIC range 0..15 when provided.
-        int cFg = fg;
-        int cBg = bg;
-        if (cFg >= 0) {
-            if (cFg < 0) cFg = 0;
-            if (cFg > 15) cFg = 15;
-        }
-        if (cBg >= 0) {
-            if (cBg < 0) cBg = 0;
-            if (cBg > 15) cBg = 15;
-        }
-        env.screen.color(cFg, cBg);
-    }
+    basic_color(env, fg, bg);
 }
 
 void Parser::exec_RANDOMIZE() {
     // RANDOMIZE [seed]
     // If no seed, use current time.
     if (tok.kind == TokenKind::End || tok.kind == TokenKind::Colon) {
-        unsigned seed = static_cast<unsigned>(std::time(nullptr));
-        std::srand(seed);
-        env.hasLastRnd = false;
+        basic_randomize(env, false, 0.0);
         return;
     }
-
-    Value v = parseExpression();
-    unsigned seed = static_cast<unsigned>(static_cast<long long>(v.asNumber()));
-    std::srand(seed);
-    env.hasLastRnd = false;
+    basic_randomize(env, true, parseExpression().asNumber());
 }
 
 void Parser::exec_DEFINT() {
@@ -689,18 +578,7 @@ void Parser::exec_CLEAR() {
         (void)parseExpression();
     }
 
-    // CLEAR runtime state (variables/arrays), keep program intact.
-    // Many GW-BASIC programs use CLEAR n as a memory-tuning hint; they don't expect it
-    // to break active control flow. Preserve FOR/GOSUB stacks.
-    auto savedFor = env.forStack;
-    auto savedGosub = env.gosubStack;
-    bool savedInISR = env.inIntervalISR;
-
-    env.clearVars();
-
-    env.forStack = std::move(savedFor);
-    env.gosubStack = std::move(savedGosub);
-    env.inIntervalISR = savedInISR;
+    basic_clear(env);
 }
 
 void Parser::exec_KEY_CTRL() {
@@ -740,7 +618,8 @@ void Parser::exec_READ() {
     // READ var[,var...]
     while (true) {
         if (tok.kind != TokenKind::Identifier) throw ParseError("Expected variable name");
-        std::string name = tok.text;
+        std::string name(tok.text);
+        Token target = tok;
         tok = lex.next();
 
         bool isArray = false;
@@ -751,12 +630,9 @@ void Parser::exec_READ() {
             idx = (int)args[0].asNumber();
             isArray = true;
         }
+        uint32_t slot = isArray ? 0 : varSlotOf(target);
 
-        bool wantString = (!name.empty() && name.back() == '$');
-        Value v = env.readNextData(wantString, env.program);
-
-        if (isArray) env.setArrayElem(name, idx, v);
-        else env.setVar(name, v);
+        basic_assign(env, name, isArray, slot, idx, basic_read_value(env, name));
 
         if (accept(TokenKind::Comma)) continue;
         break;
@@ -773,8 +649,7 @@ void Parser::exec_BEEP() {
             (void)parseExpression();
         }
     }
-    if (env.screen.beep) env.screen.beep();
-    else std::cout << '\a' << std::flush;
+    basic_beep(env);
 }
 
 
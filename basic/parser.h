@@ -22,29 +22,50 @@
 #include <functional>
 #include <limits>
 #include <algorithm>
+#include <charconv>
 #include <filesystem>
 #include <chrono>
+#include <string_view>
 #include "token.h"
 #include "env.h"
 #include "editor.h"
 #include "string.h"
 #include "lexer.h"
+#include "builtins.h"
 
 using std::string;
 using std::vector;
 
+// How control leaves a statement or line. Errors are still reported by throwing.
+enum class ExecStatus {
+    Continue, // fall through to the next statement/line
+    Jump,     // env.pc/env.stmtInLine now point at the new position
+    Stop      // END/STOP
+};
+
 struct Parser {
     Lexer lex;
     Token tok;
 
     Env& env;
-    std::string currentLine; // full current line text (without line number)
-    size_t linePosBase = 0;  // used to compute posInLine
+    size_t stmt = 0; // index of the current ':'-separated statement in the line
+
+    // Immediate mode: `src` must outlive the Parser.
+    explicit Parser(std::string_view src, Env& e) : lex(src), env(e) {
+        tok = lex.next();
+    }
 
-    explicit Parser(std::string src, Env& e) : lex(std::move(src)), env(e) {
+    // Execute from a stored, pre-tokenized line, resuming at statement `stmt`.
+    Parser(const ProgramLine& line, size_t stmt, Env& e)
+        : lex(line, line.stmtToken(stmt)), env(e), stmt(stmt) {
         tok = lex.next();
     }
 
+    void skipRestOfLine() {
+        tok = Token{TokenKind::End, "", 0.0};
+        lex.skipToEnd();
+    }
+
     void consume(TokenKind k, const char* what) {
         if (tok.kind != k) throw ParseError(std::string("Expected ") + what);
         tok = lex.next();
@@ -55,8 +76,16 @@ struct Parser {
         return false;
     }
 
+    // Variable slot of an identifier token; immediate-mode tokens are resolved by name.
+    uint32_t varSlotOf(const Token& t) {
+        return t.var ? t.var : env.varSlot(std::string(t.text));
+    }
+    uint32_t symbolOf(const Token& t) {
+        return t.sym ? t.sym : env.internSymbol(upper_ascii(t.text));
+    }
+
     // Expression parsing (Pratt)
-    int precedence(TokenKind k) {
+    static int precedence(TokenKind k) {
         switch (k) {
             case TokenKind::KW_OR: return 1;
             case TokenKind::KW_AND: return 2;
@@ -83,14 +112,6 @@ struct Parser {
         return u;
     }
 
-    static bool isFunction(const std::string& upper) {
-        static const std::unordered_map<std::string, bool> fn = {
-            {"SIN",true},{"COS",true},{"TAN",true},{"ATN",true},{"LOG",true},{"EXP",true},{"SQR",true},{"ABS",true},{"INT",true},{"SGN",true},
-            {"RND",true},{"TIME",true},{"VAL",true},{"STR$",true},{"LEN",true},{"LEFT$",true},{"RIGHT$",true},{"MID$",true},{"CHR$",true},{"ASC",true},{"TAB",true}
-        };
-        return fn.find(upper) != fn.end();
-    }
-
     std::vector<Value> parseArgList() {
         std::vector<Value> args;
         consume(TokenKind::LParen, "'('");
@@ -105,223 +126,114 @@ struct Parser {
         return args;
     }
 
-    Value callFunction(const std::string& upper, std::vector<Value> args) {
-        auto argN = [&](size_t i)->double {
-            if (i >= args.size()) return 0.0;
-            return args[i].asNumber();
-        };
-        auto argS = [&](size_t i)->std::string {
-            if (i >= args.size()) return std::string("");
-            return args[i].asString();
-        };
-
-        if (upper == "SIN") return Value(std::sin(argN(0)));
-        if (upper == "COS") return Value(std::cos(argN(0)));
-        if (upper == "TAN") return Value(std::tan(argN(0)));
-        if (upper == "ATN") return Value(std::atan(argN(0)));
-        if (upper == "LOG") return Value(std::log(argN(0)));
-        if (upper == "EXP") return Value(std::exp(argN(0)));
-        if (upper == "SQR") return Value(std::sqrt(argN(0)));
-        if (upper == "ABS") return Value(std::fabs(argN(0)));
-        if (upper == "INT") return Value(std::floor(argN(0)));
-        if (upper == "SGN") {
-            double x = argN(0);
-            int16_t r = (x > 0) ? static_cast<int16_t>(1) : ((x < 0) ? static_cast<int16_t>(-1) : static_cast<int16_t>(0));
-            return Value(r);
-        }
-        if (upper == "RND") {
-            // GW-BASIC-ish behavior:
-            //   RND()      -> next random number
-            //   RND(x>0)   -> next random number (does NOT reseed)
-            //   RND(0)     -> repeat last random number (or generate if none)
-            //   RND(x<0)   -> reseed using abs(x) and return next random number
-
-            double x = args.empty() ? 1.0 : argN(0);
-
-            if (x == 0.0) {
-                if (!env.hasLastRnd) {
-                    double r = static_cast<double>(std::rand()) / (static_cast<double>(RAND_MAX) + 1.0);
-                    env.lastRnd = r;
-                    env.hasLastRnd = true;
-                }
-                return Value(env.lastRnd);
-            }
-
-            if (x < 0.0) {
-                long long sx = static_cast<long long>(x);
-                unsigned seed = static_cast<unsigned>(std::llabs(sx));
-                std::srand(seed);
-                env.hasLastRnd = false;
+    // Parses "(args)" for builtin `fn` into `args` (at least kMaxBuiltinArgs long).
+    size_t parseBuiltinArgs(uint8_t fn, Value* args) {
+        size_t argc = 0;
+        consume(TokenKind::LParen, "'('");
+        if (tok.kind != TokenKind::RParen) {
+            while (true) {
+                if (argc == kMaxBuiltinArgs) throw RuntimeError("Illegal function call");
+                args[argc++] = parseExpression();
+                if (accept(TokenKind::Comma)) continue;
+                break;
             }
-
-            // Generate next value
-            double r = static_cast<double>(std::rand()) / (static_cast<double>(RAND_MAX) + 1.0);
-            env.lastRnd = r;
-            env.hasLastRnd = true;
-            return Value(r);
-        }
-
-        if (upper == "TIME") {
-            // TIME(): return current time in seconds since midnight (local time).
-            // This is a numeric analogue to TIME$ in classic BASIC dialects.
-            std::time_t t = std::time(nullptr);
-            std::tm lt{};
-#if defined(_WIN32)
-            localtime_s(&lt, &t);
-#else
-            std::tm* p = std::localtime(&t);
-            if (p) lt = *p;
-#endif
-            double secs = static_cast<double>(lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec);
-            return Value(secs);
-        }
-        if (upper == "VAL") return Value(Value(argS(0)).asNumber());
-        if (upper == "STR$") return Value(Value(argN(0)).asString());
-        if (upper == "LEN") return Value(static_cast<double>(argS(0).size()));
-        if (upper == "LEFT$") {
-            auto s = argS(0);
-            int n = static_cast<int>(argN(1));
-            if (n < 0) n = 0;
-            if (static_cast<size_t>(n) > s.size()) n = static_cast<int>(s.size());
-            return Value(s.substr(0, static_cast<size_t>(n)));
-        }
-        if (upper == "RIGHT$") {
-            auto s = argS(0);
-            int n = static_cast<int>(argN(1));
-            if (n < 0) n = 0;
-            if (static_cast<size_t>(n) > s.size()) n = static_cast<int>(s.size());
-            return Value(s.substr(s.size() - static_cast<size_t>(n)));
-        }
-        if (upper == "MID$") {
-            auto s = argS(0);
-            int start = static_cast<int>(argN(1));
-            int len = (args.size() >= 3) ? static_cast<int>(argN(2)) : static_cast<int>(s.size());
-            if (start < 1) start = 1; // BASIC is 1-based
-            size_t idx = static_cast<size_t>(start - 1);
-            if (idx >= s.size()) return Value(std::string(""));
-            if (len < 0) len = 0;
-            size_t n = std::min(static_cast<size_t>(len), s.size() - idx);
-            return Value(s.substr(idx, n));
-        }
-        if (upper == "CHR$") return Value(std::string(1, static_cast<char>(static_cast<int>(argN(0)) & 0xFF)));
-        if (upper == "ASC") {
-            auto s = argS(0);
-            if (s.empty()) return Value(0.0);
-            return Value(static_cast<double>(static_cast<unsigned char>(s[0])));
         }
+        consume(TokenKind::RParen, "')'");
+        check_builtin_arity(fn, argc);
+        return argc;
+    }
 
-        // TAB(n): move cursor to 1-based column n; return "" so PRINT doesn't output 0.
-        if (upper == "TAB") {
-            int col = static_cast<int>(argN(0));
-            // side-effect print spaces (handled by helper below)
-            // return empty string
-            // NOTE: this is intentionally a side-effecting function for PRINT usage.
-            // (See helper basic_print_tab_to_column1)
-            // We call helper in-place:
-            extern void __basic_tab_side_effect(Env&, int); // forward shim (defined below)
-            __basic_tab_side_effect(env, col);
-            return Value(std::string(""));
+    static Value compareOp(TokenKind op, double lhs, double rhs) {
+        switch (op) {
+            case TokenKind::Equal: return Value::fromBool(lhs == rhs);
+            case TokenKind::NotEqual: return Value::fromBool(lhs != rhs);
+            case TokenKind::Less: return Value::fromBool(lhs < rhs);
+            case TokenKind::LessEqual: return Value::fromBool(lhs <= rhs);
+            case TokenKind::Greater: return Value::fromBool(lhs > rhs);
+            case TokenKind::GreaterEqual: return Value::fromBool(lhs >= rhs);
+            default: return Value(0.0);
         }
-
-        throw RuntimeError("Unknown function");
     }
 
-    Value applyOp(const Value& a, TokenKind op, const Value& b) {
-        auto cmp = [&](double lhs, double rhs)->Value {
-            switch (op) {
-                case TokenKind::Equal: return Value::fromBool(lhs == rhs);
-                case TokenKind::NotEqual: return Value::fromBool(lhs != rhs);
-                case TokenKind::Less: return Value::fromBool(lhs < rhs);
-                case TokenKind::LessEqual: return Value::fromBool(lhs <= rhs);
-                case TokenKind::Greater: return Value::fromBool(lhs > rhs);
-                case TokenKind::GreaterEqual: return Value::fromBool(lhs >= rhs);
-                default: return Value(0.0);
-            }
-        };
-
-        if (op == TokenKind::Plus) {
-            if (a.isString() || b.isString()) return Value(a.asString() + b.asString());
-            if (a.isInt() && b.isInt()) {
-                int32_t r = static_cast<int32_t>(a.asInt()) + static_cast<int32_t>(b.asInt());
-                return Value(Value::toInt16Checked(static_cast<double>(r)));
-            }
-            return Value(a.asNumber() + b.asNumber());
-        }
-        if (op == TokenKind::Minus) {
-            if (a.isInt() && b.isInt()) {
-                int32_t r = static_cast<int32_t>(a.asInt()) - static_cast<int32_t>(b.asInt());
-                return Value(Value::toInt16Checked(static_cast<double>(r)));
-            }
-            return Value(a.asNumber() - b.asNumber());
-        }
-        if (op == TokenKind::Star) {
-            if (a.isInt() && b.isInt()) {
-                int32_t r = static_cast<int32_t>(a.asInt()) * static_cast<int32_t>(b.asInt());
-                return Value(Value::toInt16Checked(static_cast<double>(r)));
-            }
-            return Value(a.asNumber() * b.asNumber());
-        }
-        if (op == TokenKind::Slash) {
-            return Value(a.asNumber() / b.asNumber());
-        }
-        if (op == TokenKind::Backslash) {
-            double denomN = b.asNumber();
-            if (denomN == 0.0) throw RuntimeError("Division by zero");
-
-            // GW-BASIC integer division: truncate toward zero, result is integer.
-            if (a.isInt() && b.isInt()) {
-                int16_t av = a.asInt();
-                int16_t bv = b.asInt();
+    // Both operands int16: + - * \ MOD stay in int16 with overflow checks.
+    static Value intOp(TokenKind op, int16_t av, int16_t bv) {
+        switch (op) {
+            case TokenKind::Plus:
+                return Value(Value::toInt16Checked(static_cast<double>(static_cast<int32_t>(av) + bv)));
+            case TokenKind::Minus:
+                return Value(Value::toInt16Checked(static_cast<double>(static_cast<int32_t>(av) - bv)));
+            case TokenKind::Star:
+                return Value(Value::toInt16Checked(static_cast<double>(static_cast<int32_t>(av) * bv)));
+            case TokenKind::Backslash:
+                // GW-BASIC integer division: truncate toward zero, result is integer.
+                if (bv == 0) throw RuntimeError("Division by zero");
                 // Special overflow case: -32768 \ -1
                 if (av == static_cast<int16_t>(-32768) && bv == static_cast<int16_t>(-1)) {
                     throw RuntimeError("Overflow");
                 }
-                int16_t q = static_cast<int16_t>(av / bv);
-                return Value(q);
-            }
-
-            double q = a.asNumber() / denomN;
-            double tq = std::trunc(q);
-            return Value(Value::toInt16Checked(tq));
+                return Value(static_cast<int16_t>(av / bv));
+            case TokenKind::KW_MOD:
+                if (bv == 0) throw RuntimeError("Division by zero");
+                return Value(static_cast<int16_t>(av % bv));
+            default:
+                return numOp(op, av, bv);
         }
-        if (op == TokenKind::Caret) return Value(std::pow(a.asNumber(), b.asNumber()));
-        if (op == TokenKind::KW_MOD) {
-            double denomN = b.asNumber();
-            if (denomN == 0.0) throw RuntimeError("Division by zero");
-
-            if (a.isInt() && b.isInt()) {
-                int16_t av = a.asInt();
-                int16_t bv = b.asInt();
-                int16_t r = static_cast<int16_t>(av % bv);
-                return Value(r);
-            }
+    }
 
-            double x = a.asNumber();
-            double y = denomN;
-            return Value(std::fmod(x, y));
+    // Numeric operands, at least one of them a double.
+    static Value numOp(TokenKind op, double a, double b) {
+        switch (op) {
+            case TokenKind::Plus: return Value(a + b);
+            case TokenKind::Minus: return Value(a - b);
+            case TokenKind::Star: return Value(a * b);
+            case TokenKind::Slash: return Value(a / b);
+            case TokenKind::Backslash: {
+                if (b == 0.0) throw RuntimeError("Division by zero");
+                return Value(Value::toInt16Checked(std::trunc(a / b)));
+            }
+            case TokenKind::Caret: return Value(std::pow(a, b));
+            case TokenKind::KW_MOD:
+                if (b == 0.0) throw RuntimeError("Division by zero");
+                return Value(std::fmod(a, b));
+            case TokenKind::KW_AND: return Value::fromBool((a != 0.0) && (b != 0.0));
+            case TokenKind::KW_OR: return Value::fromBool((a != 0.0) || (b != 0.0));
+            case TokenKind::Equal:
+            case TokenKind::NotEqual:
+            case TokenKind::Less:
+            case TokenKind::LessEqual:
+            case TokenKind::Greater:
+            case TokenKind::GreaterEqual:
+                return compareOp(op, a, b);
+            default:
+                throw ParseError("Unknown operator");
         }
-        if (op == TokenKind::KW_AND) return Value::fromBool((a.asNumber() != 0.0) && (b.asNumber() != 0.0));
-        if (op == TokenKind::KW_OR)  return Value::fromBool((a.asNumber() != 0.0) || (b.asNumber() != 0.0));
+    }
 
-        if (op == TokenKind::Equal || op == TokenKind::NotEqual || op == TokenKind::Less || op == TokenKind::LessEqual || op == TokenKind::Greater || op == TokenKind::GreaterEqual) {
-            if (a.isString() && b.isString()) {
+    static Value applyOp(const Value& a, TokenKind op, const Value& b) {
+        if (a.isString() || b.isString()) {
+            if (op == TokenKind::Plus) return Value(a.asString() + b.asString());
+            if (a.isString() && b.isString() && precedence(op) == 3) {
                 const auto& sa = a.asString();
                 const auto& sb = b.asString();
                 int rel = (sa < sb) ? -1 : ((sa > sb) ? 1 : 0);
-                switch (op) {
-                    case TokenKind::Equal: return Value::fromBool(rel == 0);
-                    case TokenKind::NotEqual: return Value::fromBool(rel != 0);
-                    case TokenKind::Less: return Value::fromBool(rel < 0);
-                    case TokenKind::LessEqual: return Value::fromBool(rel <= 0);
-                    case TokenKind::Greater: return Value::fromBool(rel > 0);
-                    case TokenKind::GreaterEqual: return Value::fromBool(rel >= 0);
-                    default: break;
-                }
+                return compareOp(op, rel, 0);
             }
-            return cmp(a.asNumber(), b.asNumber());
         }
+        if (a.isInt() && b.isInt()) return intOp(op, a.p.i, b.p.i);
+        return numOp(op, a.asNumber(), b.asNumber());
+    }
+
+    static Value negate(const Value& v) {
+        if (v.isInt()) {
+            int16_t iv = v.asInt();
+            if (iv == static_cast<int16_t>(-32768)) throw RuntimeError("Overflow");
+            return Value(static_cast<int16_t>(-iv));
+        }
+        return Value(-v.asNumber());
+    }
 
-        throw ParseError("Unknown operator");
+    static Value logicalNot(const Value& v) {
+        return Value::fromBool(!(v.asNumber() != 0.0));
     }
 
     Value parsePrimary() {
@@ -329,32 +241,35 @@ struct Parser {
             double v = tok.number; tok = lex.next(); return Value(v);
         }
         if (tok.kind == TokenKind::String) {
-            std::string s = tok.text; tok = lex.next(); return Value(s);
+            Value s = Value::literal(tok.str()); tok = lex.next(); return s;
         }
         if (tok.kind == TokenKind::Identifier) {
-            std::string name = tok.text;
-            std::string upper = upperName(name);
+            std::string_view name = tok.text;
+            uint32_t slot = tok.var;
+            // Stored lines carry the resolved builtin ID; immediate mode looks it up here.
+            uint8_t fn = tok.sym ? tok.fn : builtin_id(name);
             tok = lex.next();
 
             // Function calls: NAME(args)
-            if (tok.kind == TokenKind::LParen && isFunction(upper)) {
-                auto args = parseArgList();
-                return callFunction(upper, std::move(args));
+            if (fn && tok.kind == TokenKind::LParen) {
+                Value args[kMaxBuiltinArgs];
+                size_t argc = parseBuiltinArgs(fn, args);
+                return call_builtin(env, fn, args, argc);
             }
 
             // Allow TIME without parentheses (TIME == TIME())
-            if (upper == "TIME") {
-                return callFunction(upper, {});
+            if (fn == static_cast<uint8_t>(Builtin::TIME)) {
+                return call_builtin(env, fn, nullptr, 0);
             }
 
             if (tok.kind == TokenKind::LParen) {
                 auto args = parseArgList();
                 if (args.size() != 1) throw RuntimeError("Bad subscript");
                 int idx = static_cast<int>(args[0].asNumber());
-                return env.getArrayElem(name, idx);
+                return env.getArrayElem(std::string(name), idx);
             }
 
-            return env.getVar(name);
+            return slot ? env.getVar(slot) : env.getVar(std::string(name));
         }
         if (tok.kind == TokenKind::LParen) {
             tok = lex.next();
@@ -364,18 +279,11 @@ struct Parser {
         }
         if (tok.kind == TokenKind::Minus) {
             tok = lex.next();
-            Value v = parsePrimary();
-            if (v.isInt()) {
-                int16_t iv = v.asInt();
-                if (iv == static_cast<int16_t>(-32768)) throw RuntimeError("Overflow");
-                return Value(static_cast<int16_t>(-iv));
-            }
-            return Value(-v.asNumber());
+            return negate(parsePrimary());
         }
         if (tok.kind == TokenKind::KW_NOT) {
             tok = lex.next();
-            Value v = parsePrimary();
-            return Value::fromBool(!(v.asNumber() != 0.0));
+            return logicalNot(parsePrimary());
         }
         throw ParseError("Expected expression");
     }
@@ -406,18 +314,21 @@ struct Parser {
     }
 
     // Statement parsing/execution
-    void parseAndExecLine();
+    ExecStatus parseAndExecLine();
+    ExecStatus execStatements();
 
     // --- statements ---
-    void execOneStatement();
+    ExecStatus execOneStatement();
     void exec_PRINT();
     void exec_LET_or_ASSIGN();
+    bool isSelfAppend(uint32_t slot, std::string_view name) const;
+    void exec_SELF_APPEND(uint32_t slot);
     void exec_INPUT();
-    void exec_IF();
-    void exec_GOTO(bool isGosub);
-    void exec_RETURN();
+    ExecStatus exec_IF();
+    ExecStatus exec_GOTO(bool isGosub);
+    ExecStatus exec_RETURN();
     void exec_FOR();
-    void exec_NEXT();
+    ExecStatus exec_NEXT();
     void exec_DIM();
     void exec_COLOR();
     void exec_LOCATE();
@@ -431,47 +342,16 @@ struct Parser {
     void exec_DATA();
     void exec_READ();
     void exec_RESTORE();
-    void jumpToLine(int target);
+    ExecStatus jumpToLine(int target);
 
     void markLineProgress() {
-        // Save progress at a safe resume point (between statements).
-        // Skip any whitespace so resuming doesn't start at an ambiguous position.
-        size_t p = linePosBase + lex.i;
-        while (p < currentLine.size() && std::isspace(static_cast<unsigned char>(currentLine[p]))) {
-            ++p;
-        }
-        env.posInLine = p;
-    }
-    void markStatementStart() {
-        // lexer tracks the start index of the current token; for interrupts we want to
-        // resume *at* the statement keyword, not after it.
-        env.posInLine = linePosBase + lex.tokenStart;
+        // Save progress at a safe resume point: the statement after this one
+        // (one past the last statement resumes at the end of the line).
+        env.stmtInLine = stmt + 1;
     }
 
     // Timer safe-point: fire interval interrupt if needed
-    void maybeFireIntervalInterrupt() {
-        if (!env.intervalEnabled) return;
-        if (!env.intervalArmed) return;
-        if (env.inIntervalISR) return;
-        if (env.intervalSeconds <= 0.0) return;
-        if (env.intervalGosubLine <= 0) return;
-
-        auto now = std::chrono::steady_clock::now();
-        if (now < env.nextIntervalFire) return;
-
-        // Schedule next fire before jumping.
-        env.nextIntervalFire = now + std::chrono::milliseconds(
-            static_cast<int>(env.intervalSeconds * 1000.0)
-        );
-
-        // Fire ONLY between lines: resume at the start of the NEXT line after RETURN.
-        auto retIt = env.pc;
-        if (retIt != env.program.end()) ++retIt;
-
-        env.gosubStack.push_back({retIt, 0, true, env.dataPtr});
-        env.inIntervalISR = true;
-        jumpToLine(env.intervalGosubLine);
-    }
+    ExecStatus maybeFireIntervalInterrupt();
 };
 
 
@@ -535,25 +415,57 @@ static constexpr int BASIC_TAB_WIDTH = 14;
 
 static inline void basic_print_char(Env& env, char c) {
     if (env.screen.putChar) env.screen.putChar(c);
+    else if (env.screen.write) env.screen.write(std::string_view(&c, 1));
     else std::cout << c;
 
     if (c == '\n' || c == '\r') env.printCol = 0;
     else env.printCol++;
 }
 
-static inline void basic_print_string(Env& env, const std::string& s) {
-    for (char c : s) basic_print_char(env, c);
+// One driver call per span; the column is taken from the last line break in it.
+static inline void basic_print_string(Env& env, std::string_view s) {
+    if (s.empty()) return;
+    if (env.screen.write) env.screen.write(s);
+    else if (env.screen.putChar) for (char c : s) env.screen.putChar(c);
+    else std::cout.write(s.data(), static_cast<std::streamsize>(s.size()));
+
+    size_t nl = s.find_last_of("\r\n");
+    if (nl == std::string_view::npos) env.printCol += static_cast<int>(s.size());
+    else env.printCol = static_cast<int>(s.size() - nl - 1);
+}
+
+// Numbers are formatted into a local buffer (same text as Value::asString) rather
+// than through an ostringstream.
+static inline void basic_print_value(Env& env, const Value& v) {
+    if (v.isString()) {
+        basic_print_string(env, v.asString());
+        return;
+    }
+    char buf[32];
+    std::to_chars_result r = v.isInt()
+        ? std::to_chars(buf, buf + sizeof(buf), static_cast<int>(v.p.i))
+        : std::to_chars(buf, buf + sizeof(buf), v.p.d, std::chars_format::general, 6);
+    basic_print_string(env, std::string_view(buf, static_cast<size_t>(r.ptr - buf)));
+}
+
+static inline void basic_print_spaces(Env& env, int n) {
+    static constexpr std::string_view blanks = "                                ";
+    while (n > 0) {
+        int k = std::min(n, static_cast<int>(blanks.size()));
+        basic_print_string(env, blanks.substr(0, static_cast<size_t>(k)));
+        n -= k;
+    }
 }
 
 static inline void basic_print_tab_to_next_stop(Env& env) {
     int next = ((env.printCol / BASIC_TAB_WIDTH) + 1) * BASIC_TAB_WIDTH;
-    while (env.printCol < next) basic_print_char(env, ' ');
+    basic_print_spaces(env, next - env.printCol);
 }
 
 static inline void basic_print_tab_to_column1(Env& env, int col1based) {
     if (col1based < 1) col1based = 1;
     int target = col1based - 1;
-    while (env.printCol < target) basic_print_char(env, ' ');
+    basic_print_spaces(env, target - env.printCol);
 }
 
 // --- RUN immediate command support ---
@@ -15,6 +15,10 @@
 #include <mutex>
 #include <atomic>
 
+#include "interpreter.h"
+
+#if BASIC_USE_SDL
+
 #if defined(__APPLE__)
 #include <pthread.h>
 #endif
@@ -22,7 +26,7 @@
 #include "SDL.h"
 #include "SDL_ttf.h"
 
-#include "interpreter.h"
+#include "glyph_atlas.h"
 
 namespace {
 
@@ -46,7 +50,81 @@ struct SDLTerminalBuffer {
 
     std::vector<Cell> grid;
 
-    SDLTerminalBuffer() { grid.assign((size_t)(cols * rows), Cell{}); }
+    // Damage: a counter bumped on every visible change (cells, cursor, colours), and
+    // per row the counter value of its last change.
+    std::vector<uint64_t> rowVersion;
+    uint64_t generation = 0;
+
+    // What the renderer draws. Writers change the grid above under the terminal
+    // mutex and publish a copy on release; the renderer reads the newest copy
+    // without taking the mutex. Triple buffered: writers own `back`, the renderer
+    // owns `front`, and the third slot is swapped through `shared` (its index, plus
+    // kFresh while the renderer has not taken it).
+    struct Snapshot {
+        std::vector<Cell> grid;
+        std::vector<uint64_t> rowVersion;
+        uint64_t generation = 0;
+        int curRow = 0;
+        int curCol = 0;
+        bool cursorVisible = true;
+        uint8_t curFg = 7;
+        uint8_t curBg = 0;
+    };
+    static constexpr uint8_t kFresh = 4;
+    Snapshot slots[3];
+    uint8_t back = 0;
+    uint8_t front = 1;
+    std::atomic<uint8_t> shared{2};
+    std::atomic<uint64_t> latest{0}; // generation at the last writer release
+
+    SDLTerminalBuffer() {
+        grid.assign((size_t)(cols * rows), Cell{});
+        rowVersion.assign((size_t)rows, 0);
+        for (Snapshot& s : slots) {
+            s.grid = grid;
+            s.rowVersion = rowVersion;
+        }
+    }
+
+    void touch() { ++generation; }
+    void touchRow(int r) { rowVersion[(size_t)r] = ++generation; }
+    void touchAll() { ++generation; std::fill(rowVersion.begin(), rowVersion.end(), generation); }
+
+    // Writer side, with the mutex held. While the renderer has not taken the last
+    // copy there is nothing to do: it asks again (acquire) once it has.
+    void publish() {
+        latest.store(generation, std::memory_order_release);
+        Snapshot& s = slots[back];
+        if (s.generation == generation) return;
+        if (shared.load(std::memory_order_acquire) & kFresh) return;
+
+        for (int r = 0; r < rows; ++r) {
+            if (s.rowVersion[(size_t)r] == rowVersion[(size_t)r]) continue;
+            std::copy_n(&grid[(size_t)(r * cols)], cols, &s.grid[(size_t)(r * cols)]);
+            s.rowVersion[(size_t)r] = rowVersion[(size_t)r];
+        }
+        s.generation = generation;
+        s.curRow = curRow;
+        s.curCol = curCol;
+        s.cursorVisible = cursorVisible;
+        s.curFg = curFg;
+        s.curBg = curBg;
+        back = shared.exchange((uint8_t)(back | kFresh), std::memory_order_acq_rel) & 3;
+    }
+
+    // Renderer side: the newest published copy. If writers changed the grid after the
+    // last publish, publish here too, but only if no writer holds the mutex.
+    const Snapshot& acquire(std::mutex& m) {
+        if (!(shared.load(std::memory_order_acquire) & kFresh) &&
+            slots[front].generation != latest.load(std::memory_order_acquire)) {
+            std::unique_lock<std::mutex> lock(m, std::try_to_lock);
+            if (lock.owns_lock()) publish();
+        }
+        if (shared.load(std::memory_order_acquire) & kFresh) {
+            front = shared.exchange(front, std::memory_order_acq_rel) & 3;
+        }
+        return slots[front];
+    }
 
     void clear() {
         Cell blank;
@@ -57,22 +135,39 @@ struct SDLTerminalBuffer {
         std::fill(grid.begin(), grid.end(), blank);
         curRow = 0;
         curCol = 0;
+        touchAll();
     }
 
     void setColor(int fg, int bg) {
         if (fg >= 0) { fg = std::clamp(fg, 0, 15); curFg = (uint8_t)fg; }
         if (bg >= 0) { bg = std::clamp(bg, 0, 15); curBg = (uint8_t)bg; }
+        touch(); // border and cursor colour
     }
 
-    void showCursor(bool show) { cursorVisible = show; }
+    void showCursor(bool show) { cursorVisible = show; touch(); }
 
     void locate1(int row1, int col1) {
         int r = row1 - 1;
         int c = col1 - 1;
         r = std::clamp(r, 0, rows - 1);
         c = std::clamp(c, 0, cols - 1);
+        moveCursor(r, c);
+    }
+
+    void moveCursor(int r, int c) {
         curRow = r;
         curCol = c;
+        touch();
+    }
+
+    // Write a cell in the current colours without moving the cursor.
+    void setCell(int r, int c, char ch) {
+        if (r < 0 || c < 0 || r >= rows || c >= cols) return;
+        Cell& cell = grid[(size_t)(r * cols + c)];
+        cell.ch = ch;
+        cell.fg = curFg;
+        cell.bg = curBg;
+        touchRow(r);
     }
 
     void scrollUp() {
@@ -83,11 +178,13 @@ struct SDLTerminalBuffer {
             grid[(size_t)((rows - 1) * cols + c)] = Cell{};
         }
         if (curRow > 0) curRow--;
+        touchAll();
     }
 
     void newline() {
         curCol = 0;
         curRow++;
+        touch();
         if (curRow >= rows) {
             scrollUp();
             curRow = rows - 1;
@@ -95,7 +192,7 @@ struct SDLTerminalBuffer {
     }
 
     void putChar(char c) {
-        if (c == '\r') { curCol = 0; return; }
+        if (c == '\r') { curCol = 0; touch(); return; }
         if (c == '\n') { newline(); return; }
         if (c == '\t') {
             int next = ((curCol / 8) + 1) * 8;
@@ -108,12 +205,13 @@ struct SDLTerminalBuffer {
         cell.ch = c;
         cell.fg = curFg;
         cell.bg = curBg;
+        touchRow(curRow);
 
         curCol++;
         if (curCol >= cols) newline();
     }
 
-    void write(const std::string& s) { for (char c : s) putChar(c); }
+    void write(std::string_view s) { for (char c : s) putChar(c); }
 
     void pushLine(const std::string& s) {
         write(s);
@@ -121,6 +219,15 @@ struct SDLTerminalBuffer {
     }
 };
 
+// Lock for changing the terminal; publishes it for the renderer on release.
+struct SDLTerminalEdit {
+    SDLTerminalBuffer& term;
+    std::lock_guard<std::mutex> lock;
+
+    SDLTerminalEdit(SDLTerminalBuffer& t, std::mutex& m) : term(t), lock(m) {}
+    ~SDLTerminalEdit() { term.publish(); }
+};
+
 struct SDLTerminalStreamBuf : public std::streambuf {
     SDLTerminalBuffer* buf = nullptr;
     std::mutex* mtx = nullptr;
@@ -132,7 +239,7 @@ struct SDLTerminalStreamBuf : public std::streambuf {
         if (ch == EOF) return EOF;
         char c = (char)ch;
         if (c == '\n') {
-            std::lock_guard<std::mutex> lock(*mtx);
+            SDLTerminalEdit edit(*buf, *mtx);
             if (!pending.empty()) {
                 buf->write(pending);
                 pending.clear();
@@ -141,7 +248,7 @@ struct SDLTerminalStreamBuf : public std::streambuf {
         } else {
             pending.push_back(c);
             if (pending.size() > 4096) {
-                std::lock_guard<std::mutex> lock(*mtx);
+                SDLTerminalEdit edit(*buf, *mtx);
                 buf->write(pending);
                 pending.clear();
             }
@@ -151,7 +258,7 @@ struct SDLTerminalStreamBuf : public std::streambuf {
 
     int sync() override {
         if (!pending.empty()) {
-            std::lock_guard<std::mutex> lock(*mtx);
+            SDLTerminalEdit edit(*buf, *mtx);
             buf->write(pending);
             pending.clear();
         }
@@ -262,6 +369,18 @@ void Interpreter::repl_sdl2_ttf() {
         return;
     }
 
+    // Glyphs for the current font; rebuilt on first draw after the font changes.
+    GlyphAtlas atlas;
+
+    // Persistent image of the character grid. Only rows the terminal marks dirty are
+    // repainted into it; a frame is presented only when something visible changed.
+    const bool targetsSupported = SDL_RenderTargetSupported(renderer);
+    SDL_Texture* screenTex = nullptr;
+    bool repaintAll = true;      // screenTex content is missing or stale
+    bool presentNeeded = true;   // window, insets or the editor touched the backbuffer
+    uint64_t drawnGeneration = 0;
+    std::vector<uint64_t> drawnRows; // per row, the version last drawn into screenTex
+
     // Raising again after renderer creation can help on some macOS setups.
     SDL_RaiseWindow(win);
 #if SDL_VERSION_ATLEAST(2,0,5)
@@ -355,6 +474,7 @@ void Interpreter::repl_sdl2_ttf() {
         if (!bestFont) return false;
 
         font = bestFont;
+        atlas.reset();
         ptSize = bestPt;
         charW = bestCW;
         charH = bestCH;
@@ -365,6 +485,7 @@ void Interpreter::repl_sdl2_ttf() {
 
     auto open_fixed_font = [&](int fixedPt) -> bool {
         if (font) { TTF_CloseFont(font); font = nullptr; }
+        atlas.reset();
         if (!sdl_try_open_font(font, fixedPt)) return false;
         ptSize = fixedPt;
         measure_cell(font, charW, charH);
@@ -382,6 +503,7 @@ void Interpreter::repl_sdl2_ttf() {
 
         insetX = (int)lroundf(16.0f * padScaleX);
         insetY = (int)lroundf(16.0f * padScaleY);
+        presentNeeded = true;
     };
 
     auto size_window_for_80x25 = [&]() {
@@ -485,17 +607,18 @@ void Interpreter::repl_sdl2_ttf() {
 
 
     SDLTerminalBuffer term;
-    term.pushLine("GW-BASIC-like interpreter. Use RUN, LIST, EDIT, NEW, CLEAR, CONT, DELETE n, SAVE \"file\", LOAD \"file\", and QUIT.");
+    term.pushLine("GW-BASIC-like interpreter. Use RUN, LIST, EDIT, NEW, CLEAR, CONT, ENGINE, DELETE n, SAVE \"file\", LOAD \"file\", and QUIT.");
 
     std::mutex termMutex;
 
     // Wire BASIC screen driver to the SDL terminal buffer, locking for thread safety
-    env.screen.putChar = [&](char c) { std::lock_guard<std::mutex> lock(termMutex); term.putChar(c); };
-    env.screen.cls = [&]() { std::lock_guard<std::mutex> lock(termMutex); term.clear(); };
-    env.screen.locate = [&](int row, int col) { std::lock_guard<std::mutex> lock(termMutex); term.locate1(row, col); };
-    env.screen.showCursor = [&](bool show) { std::lock_guard<std::mutex> lock(termMutex); term.showCursor(show); };
+    env.screen.putChar = [&](char c) { SDLTerminalEdit edit(term, termMutex); term.putChar(c); };
+    env.screen.write = [&](std::string_view s) { SDLTerminalEdit edit(term, termMutex); term.write(s); };
+    env.screen.cls = [&]() { SDLTerminalEdit edit(term, termMutex); term.clear(); };
+    env.screen.locate = [&](int row, int col) { SDLTerminalEdit edit(term, termMutex); term.locate1(row, col); };
+    env.screen.showCursor = [&](bool show) { SDLTerminalEdit edit(term, termMutex); term.showCursor(show); };
     env.screen.color = [&](int fg, int bg) {
-        std::lock_guard<std::mutex> lock(termMutex);
+        SDLTerminalEdit edit(term, termMutex);
         int useFg = (fg < 0) ? term.curFg : fg;
         int useBg = (bg < 0) ? term.curBg : bg;
         term.setColor(useFg, useBg);
@@ -521,16 +644,10 @@ void Interpreter::repl_sdl2_ttf() {
     int programInputAnchorCol = 0;
     bool programInputActive = false;
 
-    auto putAt0 = [&](int r, int c, char ch) {
-        if (r < 0 || c < 0 || r >= term.rows || c >= term.cols) return;
-        auto& cell = term.grid[(size_t)(r * term.cols + c)];
-        cell.ch = ch;
-        cell.fg = term.curFg;
-        cell.bg = term.curBg;
-    };
+    auto putAt0 = [&](int r, int c, char ch) { term.setCell(r, c, ch); };
 
     auto beginPrompt = [&]() {
-        std::lock_guard<std::mutex> lock(termMutex);
+        SDLTerminalEdit edit(term, termMutex);
         term.setColor(15, 0);
         term.write("OK> ");
         inputAnchorRow = term.curRow;
@@ -545,8 +662,7 @@ void Interpreter::repl_sdl2_ttf() {
         int r = inputAnchorRow + (pos / term.cols);
         int c = (pos % term.cols);
         if (r >= term.rows) r = term.rows - 1;
-        term.curRow = r;
-        term.curCol = c;
+        term.moveCursor(r, c);
     };
 
     auto eraseCurrentInput = [&]() {
@@ -562,7 +678,7 @@ void Interpreter::repl_sdl2_ttf() {
     };
 
     auto redrawInput = [&](const std::string& newLine) {
-        std::lock_guard<std::mutex> lock(termMutex);
+        SDLTerminalEdit edit(term, termMutex);
         eraseCurrentInput();
         line = newLine;
         int pos0 = inputAnchorCol;
@@ -577,7 +693,7 @@ void Interpreter::repl_sdl2_ttf() {
     };
 
     auto beginProgramInput = [&]() {
-        std::lock_guard<std::mutex> lock(termMutex);
+        SDLTerminalEdit edit(term, termMutex);
         programInputActive = true;
         programInput.clear();
         programInputAnchorRow = term.curRow;
@@ -597,7 +713,7 @@ void Interpreter::repl_sdl2_ttf() {
     };
 
     auto redrawProgramInput = [&](const std::string& newLine) {
-        std::lock_guard<std::mutex> lock(termMutex);
+        SDLTerminalEdit edit(term, termMutex);
         eraseProgramInput();
         programInput = newLine;
         int pos0 = programInputAnchorCol;
@@ -613,8 +729,7 @@ void Interpreter::repl_sdl2_ttf() {
         int r = programInputAnchorRow + (pos / term.cols);
         int c = (pos % term.cols);
         if (r >= term.rows) r = term.rows - 1;
-        term.curRow = r;
-        term.curCol = c;
+        term.moveCursor(r, c);
     };
 
     bool running = true;
@@ -633,7 +748,7 @@ void Interpreter::repl_sdl2_ttf() {
         programInputActive = false;
         programInput.clear();
         {
-            std::lock_guard<std::mutex> lock(termMutex);
+            SDLTerminalEdit edit(term, termMutex);
             term.putChar('\n');
         }
         beginPrompt();
@@ -647,13 +762,14 @@ void Interpreter::repl_sdl2_ttf() {
 
         if (debugStepping) {
             if (sdlDebugNeedPrint) {
-                if (env.pc != env.program.end()) {
-                    int ln = env.pc->first;
-                    const std::string& full = env.pc->second;
+                if (env.pc < env.lines.size()) {
+                    int ln = env.lines[env.pc].number;
+                    const ProgramLine& pl = *env.lines[env.pc].line;
+                    const std::string& full = pl.text;
 
                     std::cout << "\n[DEBUG] Line " << ln << ": " << full << "\n";
-                    if (env.posInLine > 0 && env.posInLine < (int)full.size()) {
-                        std::cout << "[DEBUG] At: " << full.substr((size_t)env.posInLine) << "\n";
+                    if (env.stmtInLine > 0 && pl.tokenized() && pl.stmtOffset(env.stmtInLine) < full.size()) {
+                        std::cout << "[DEBUG] At: " << full.substr(pl.stmtOffset(env.stmtInLine)) << "\n";
                     }
                     std::cout << "[DEBUG] Variables:\n";
                     basic_dump_vars(env, 0);
@@ -676,29 +792,24 @@ void Interpreter::repl_sdl2_ttf() {
             return;
         }
 
-        if (env.pc == env.program.end()) {
+        if (env.pc >= env.lines.size()) {
             env.running = false;
             env.contAvailable = false;
             finishProgramRun();
             return;
         }
 
-        int currentLineNumber = env.pc->first;
-        std::string lineText = env.pc->second;
-
-        std::string toParse;
-        if (env.posInLine > 0 && env.posInLine < (int)lineText.size())
-            toParse = lineText.substr((size_t)env.posInLine);
-        else { env.posInLine = 0; toParse = lineText; }
-
-        Parser p(toParse, env);
-        p.currentLine = lineText;
-        p.linePosBase = env.posInLine;
+        const Env::LineRecord& cur = env.lines[env.pc];
+        int currentLineNumber = cur.number;
+        Parser p(*cur.line, env.stmtInLine, env);
 
         try {
-            p.parseAndExecLine();
+            if (p.parseAndExecLine() != ExecStatus::Continue) {
+                if (debugStepping) { sdlDebugNeedPrint = true; sdlDebugPaused = false; }
+                return;
+            }
             env.pc++;
-            env.posInLine = 0;
+            env.stmtInLine = 0;
 
             SDL_Delay(0);
 
@@ -708,10 +819,6 @@ void Interpreter::repl_sdl2_ttf() {
                 return;
             }
         } catch (const RuntimeError& e) {
-            if (std::string(e.what()) == "__JUMP__") {
-                if (debugStepping) { sdlDebugNeedPrint = true; sdlDebugPaused = false; }
-                return;
-            }
             std::cout << "Runtime error in " << currentLineNumber << ": " << e.what() << "\n";
             env.running = false;
             env.contAvailable = true;
@@ -727,9 +834,9 @@ void Interpreter::repl_sdl2_ttf() {
     auto commitLine = [&](const std::string& raw) {
         std::string t = trim(raw);
 
-        moveCursorToInputEnd();
         {
-            std::lock_guard<std::mutex> lock(termMutex);
+            SDLTerminalEdit edit(term, termMutex);
+            moveCursorToInputEnd();
             term.putChar('\n');
         }
 
@@ -745,10 +852,9 @@ void Interpreter::repl_sdl2_ttf() {
             std::istringstream iss(t);
             int ln = 0;
             iss >> ln;
-            if (ln <= 0) { std::cout << "Bad line number\n"; beginPrompt(); return; }
             std::string rest;
             std::getline(iss, rest);
-            storeProgramLine(ln, trim(rest));
+            if (!storeProgramLine(ln, trim(rest))) std::cout << "Bad line number\n";
             beginPrompt();
             return;
         }
@@ -758,8 +864,8 @@ void Interpreter::repl_sdl2_ttf() {
         for (char c : t) upper.push_back((char)std::toupper((unsigned char)c));
 
         if (upper == "RUN") {
-            startRun();
             debugStepping = false;
+            startRun();
             programDone.store(false, std::memory_order_relaxed);
             programRunning = true;
             if (programThread.joinable()) programThread.join();
@@ -771,8 +877,8 @@ void Interpreter::repl_sdl2_ttf() {
         }
 
         if (upper == "DEBUG") {
-            startRun();
             debugStepping = true;
+            startRun();
             sdlDebugPaused = false;
             sdlDebugNeedPrint = true;
             programRunning = true;
@@ -782,6 +888,7 @@ void Interpreter::repl_sdl2_ttf() {
         if (istartswith(upper, "LIST")) { cmd_LIST(trim(t.substr(4))); beginPrompt(); return; }
         if (upper == "NEW") { cmd_NEW(); beginPrompt(); return; }
         if (upper == "CLEAR") { cmd_CLEAR(); beginPrompt(); return; }
+        if (istartswith(upper, "ENGINE")) { cmd_ENGINE(t.substr(6)); beginPrompt(); return; }
 
         if (upper == "CONT") {
             startCont();
@@ -834,8 +941,8 @@ void Interpreter::repl_sdl2_ttf() {
 
             cmd_LOAD(fn);
             if (runAfterLoad) {
-                startRun();
                 debugStepping = false;
+                startRun();
                 programDone.store(false, std::memory_order_relaxed);
                 programRunning = true;
                 if (programThread.joinable()) programThread.join();
@@ -868,10 +975,12 @@ void Interpreter::repl_sdl2_ttf() {
                                charW, charH,
                                insetX, insetY);
             std::cout.rdbuf(&sb);
+            presentNeeded = true;
 
             SDL_StartTextInput();
             SDL_FlushEvent(SDL_TEXTINPUT);
 
+            tokenizeProgram();
             resetAfterProgramEdit();
             beginPrompt();
             return;
@@ -886,14 +995,24 @@ void Interpreter::repl_sdl2_ttf() {
 
     while (running) {
         if (g_sigint_requested.exchange(false, std::memory_order_relaxed)) {
-            term.pushLine("Break");
+            {
+                SDLTerminalEdit edit(term, termMutex);
+                term.pushLine("Break");
+            }
             beginPrompt();
         }
 
         SDL_Event e;
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) { running = false; break; }
+            if (e.type == SDL_RENDER_DEVICE_RESET) {
+                atlas.reset();
+                if (screenTex) { SDL_DestroyTexture(screenTex); screenTex = nullptr; }
+                continue;
+            }
+            if (e.type == SDL_RENDER_TARGETS_RESET) { repaintAll = true; continue; }
             if (e.type == SDL_WINDOWEVENT) {
+                presentNeeded = true;
                 if (applyingDisplayMode) continue;
 
                 // If the user toggles fullscreen via the title-bar green button,
@@ -924,7 +1043,7 @@ void Interpreter::repl_sdl2_ttf() {
                     if (!programInputActive) beginProgramInput();
                     const char* t = e.text.text;
                     if (t) {
-                        std::lock_guard<std::mutex> lock(termMutex);
+                        SDLTerminalEdit edit(term, termMutex);
                         for (const char* p = t; *p; ++p) {
                             programInput.push_back(*p);
                             term.putChar(*p);
@@ -935,7 +1054,7 @@ void Interpreter::repl_sdl2_ttf() {
                 if (historyNav) { historyNav = false; historyIndex = -1; }
                 const char* t = e.text.text;
                 if (t) {
-                    std::lock_guard<std::mutex> lock(termMutex);
+                    SDLTerminalEdit edit(term, termMutex);
                     for (const char* p = t; *p; ++p) {
                         line.push_back(*p);
                         term.putChar(*p);
@@ -966,7 +1085,7 @@ void Interpreter::repl_sdl2_ttf() {
                             sdl_post_input_line(programInput);
                             programInputActive = false;
                             {
-                                std::lock_guard<std::mutex> lock(termMutex);
+                                SDLTerminalEdit edit(term, termMutex);
                                 term.putChar('\n');
                             }
                             continue;
@@ -1003,9 +1122,11 @@ void Interpreter::repl_sdl2_ttf() {
                 if (sym == SDLK_F5) { redrawInput("RUN"); commitLine("RUN"); continue; }
 
                 if ((mod & KMOD_CTRL) && (sym == SDLK_l)) {
-                    std::lock_guard<std::mutex> lock(termMutex);
-                    term.clear();
-                    term.pushLine("(cleared)");
+                    {
+                        SDLTerminalEdit edit(term, termMutex);
+                        term.clear();
+                        term.pushLine("(cleared)");
+                    }
                     beginPrompt();
                     continue;
                 }
@@ -1059,66 +1180,83 @@ void Interpreter::repl_sdl2_ttf() {
             return pal[idx & 15];
         };
 
-        // Clear with actual background (COLOR bg)
-        {
-            std::lock_guard<std::mutex> lock(termMutex);
-            SDL_Color bgc = basicPalette(term.curBg);
-            SDL_SetRenderDrawColor(renderer, bgc.r, bgc.g, bgc.b, 255);
-            SDL_RenderClear(renderer);
-        }
-
         const int cellW = charW;
         const int cellH = charH;
+        if (!atlas.ready() || atlas.cellW != cellW || atlas.cellH != cellH) {
+            atlas.build(renderer, font, cellW, cellH);
+            if (screenTex) { SDL_DestroyTexture(screenTex); screenTex = nullptr; }
+        }
+        if (!screenTex && targetsSupported) {
+            screenTex = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                          term.cols * cellW, term.rows * cellH);
+            if (screenTex) SDL_SetTextureBlendMode(screenTex, SDL_BLENDMODE_NONE);
+            repaintAll = true;
+        }
+        // Without a render target every frame draws the whole grid to the window.
+        const bool direct = (screenTex == nullptr);
+        const int originX = direct ? insetX : 0;
+        const int originY = direct ? insetY : 0;
+
+        // Draw from the latest published snapshot; writers are never blocked by it.
+        const auto& snap = term.acquire(termMutex);
+        const bool changed = presentNeeded || repaintAll || snap.generation != drawnGeneration;
+
+        if (!changed) {
+            // Nothing to show: sleep until an event arrives or a running program may
+            // have printed, instead of presenting identical frames at vsync rate.
+            SDL_WaitEventTimeout(nullptr, programRunning ? 10 : 100);
+            continue;
+        }
 
-        std::lock_guard<std::mutex> lock(termMutex);
-
+        // Queue the rows that changed since they were drawn: backgrounds first, then glyphs.
+        const bool all = repaintAll || direct;
+        atlas.clear();
         for (int r = 0; r < term.rows; ++r) {
+            if (!all && snap.rowVersion[(size_t)r] == drawnRows[(size_t)r]) continue;
+            const auto* row = &snap.grid[(size_t)(r * term.cols)];
             int c = 0;
             while (c < term.cols) {
-                const auto& cell0 = term.grid[(size_t)(r * term.cols + c)];
-                uint8_t fg = cell0.fg;
-                uint8_t bg = cell0.bg;
-
+                uint8_t bg = row[c].bg;
                 int cStart = c;
-                std::string run;
-                run.reserve((size_t)term.cols);
-
-                while (c < term.cols) {
-                    const auto& cell = term.grid[(size_t)(r * term.cols + c)];
-                    if (cell.fg != fg || cell.bg != bg) break;
-                    run.push_back(cell.ch ? cell.ch : ' ');
-                    ++c;
-                }
-
-                SDL_Color bgc = basicPalette(bg);
-                SDL_SetRenderDrawColor(renderer, bgc.r, bgc.g, bgc.b, bgc.a);
-                SDL_Rect bgRect{ insetX + cStart*cellW, insetY + r*cellH, (c - cStart)*cellW, cellH };
-                SDL_RenderFillRect(renderer, &bgRect);
-
-                bool allSpace = true;
-                for (char ch : run) { if (ch != ' ') { allSpace = false; break; } }
-
-                if (!allSpace) {
-                    SDL_Color fgc = basicPalette(fg);
-                    int tw=0, th=0;
-                    SDL_Texture* tex = sdl_make_text_texture(renderer, font, run, fgc, tw, th);
-                    if (tex) {
-                        SDL_Rect dst{ insetX + cStart*cellW, insetY + r*cellH, tw, th };
-                        SDL_RenderCopy(renderer, tex, nullptr, &dst);
-                        SDL_DestroyTexture(tex);
-                    }
-                }
+                while (c < term.cols && row[c].bg == bg) ++c;
+                atlas.fill(originX + cStart*cellW, originY + r*cellH, (c - cStart)*cellW, cellH, basicPalette(bg));
+            }
+        }
+        for (int r = 0; r < term.rows; ++r) {
+            if (!all && snap.rowVersion[(size_t)r] == drawnRows[(size_t)r]) continue;
+            const auto* row = &snap.grid[(size_t)(r * term.cols)];
+            for (int c = 0; c < term.cols; ++c) {
+                atlas.glyph(originX + c*cellW, originY + r*cellH, (unsigned char)row[c].ch, basicPalette(row[c].fg));
             }
         }
+        drawnRows = snap.rowVersion;
+        drawnGeneration = snap.generation;
+
+        if (!direct) {
+            SDL_SetRenderTarget(renderer, screenTex);
+            atlas.draw(renderer);
+            SDL_SetRenderTarget(renderer, nullptr);
+        }
+        SDL_Color clearColor = basicPalette(snap.curBg);
+        SDL_SetRenderDrawColor(renderer, clearColor.r, clearColor.g, clearColor.b, 255);
+        SDL_RenderClear(renderer);
+        if (direct) {
+            atlas.draw(renderer);
+        } else {
+            SDL_Rect dst{ insetX, insetY, term.cols * cellW, term.rows * cellH };
+            SDL_RenderCopy(renderer, screenTex, nullptr, &dst);
+        }
 
-        if (term.cursorVisible) {
-            SDL_Color cc = basicPalette(term.curFg);
+        if (snap.cursorVisible) {
+            SDL_Color cc = basicPalette(snap.curFg);
             SDL_SetRenderDrawColor(renderer, cc.r, cc.g, cc.b, 255);
-            SDL_Rect curRect{ insetX + term.curCol*cellW, insetY + term.curRow*cellH, cellW, cellH };
+            SDL_Rect curRect{ insetX + snap.curCol*cellW, insetY + snap.curRow*cellH, cellW, cellH };
             SDL_RenderDrawRect(renderer, &curRect);
         }
 
         SDL_RenderPresent(renderer);
+        repaintAll = false;
+        presentNeeded = false;
     }
 
     if (programThread.joinable()) {
@@ -1132,6 +1270,8 @@ void Interpreter::repl_sdl2_ttf() {
     env.screen = {};
     std::cout.rdbuf(oldCout);
     sdl_ui_active_flag().store(false, std::memory_order_relaxed);
+    if (screenTex) SDL_DestroyTexture(screenTex);
+    atlas.reset();
     TTF_CloseFont(font);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(win);
@@ -1139,3 +1279,4 @@ void Interpreter::repl_sdl2_ttf() {
     SDL_Quit();
 }
 
+#endif // BASIC_USE_SDL
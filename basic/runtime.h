@@ -0,0 +1,156 @@
+//
+//  runtime.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+// Runtime for programs translated to C++ by COMPILE. It is the interpreter's own Env,
+// Value and operator semantics without the engines or SDL, so a compiled program
+// behaves like RUN in the console. Generated code includes this header and links
+// builtins.cpp:
+//
+//   c++ -std=gnu++20 -O2 -iquote <basic sources> prog.cpp <basic sources>/builtins.cpp -o prog
+//
+// (-iquote, not -I: the sources have their own string.h.)
+
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "parser.h"
+#include "builtins.h"
+#include "statements.h"
+
+struct BasicRuntime {
+    struct DataLine {
+        int line;
+        const char* text;
+    };
+
+    // FOR and GOSUB frames resume at a label chosen by the generated dispatch switch.
+    struct ForFrame {
+        uint32_t var;
+        uint32_t sym;
+        Env::ForCounter counter;
+        int resume;
+    };
+    struct GosubFrame {
+        int resume;
+        bool isInterval = false;
+        size_t savedDataPtr = 0;
+    };
+
+    Env env;
+    std::vector<ForFrame> forStack;
+    std::vector<GosubFrame> gosubStack;
+    int line = 0; // for error messages
+
+    // Variable slots are created in the order the translator saw them, so the slot
+    // numbers in the generated code are valid. DATA lines keep their text for READ.
+    BasicRuntime(const char* const* varNames, size_t varCount, const DataLine* data, size_t dataCount) {
+        for (size_t i = 1; i < varCount; ++i) env.varSlot(varNames[i]);
+        for (size_t i = 0; i < dataCount; ++i) env.storeLine(data[i].line).text = data[i].text;
+        env.running = true;
+        env.restoreData(0, env.program);
+    }
+
+    // -------------------- Expressions (VM::run fast paths) --------------------
+
+    static bool truthy(const Value& v) { return v.asNumber() != 0.0; }
+
+    static Value binI(TokenKind op, const Value& lhs, const Value& rhs) {
+        if (lhs.isInt() && rhs.isInt()) return Parser::intOp(op, lhs.p.i, rhs.p.i);
+        return Parser::applyOp(lhs, op, rhs);
+    }
+
+    static Value binN(TokenKind op, const Value& lhs, const Value& rhs) {
+        bool num = (lhs.isDouble() && rhs.isNumber()) || (rhs.isDouble() && lhs.isNumber());
+        if (num) return Parser::numOp(op, lhs.asNumber(), rhs.asNumber());
+        return Parser::applyOp(lhs, op, rhs);
+    }
+
+    void storeIntOp(uint32_t slot, TokenKind op, Value lhs, Value rhs, uint8_t flag) {
+        basic_store_int_op(env, slot, op, std::move(lhs), std::move(rhs), flag);
+    }
+
+    void addVarConst(uint32_t slot, const Value& k, uint8_t flag) { basic_add_var_const(env, slot, k, flag); }
+
+    bool ifVarConst(uint32_t slot, TokenKind op, const Value& k) { return basic_if_var_const(env, slot, op, k); }
+
+    // -------------------- FOR / GOSUB --------------------
+
+    void forInit(uint32_t var, uint32_t sym, const Value& start, const Value& end, const Value& step,
+                 bool hasStep, int resume) {
+        Env::ForCounter counter = basic_for_start(env, var, start.asNumber(), end.asNumber(), step.asNumber(), hasStep);
+        basic_push_for(forStack, ForFrame{var, sym, counter, resume});
+    }
+
+    // Resume id of the loop body, or -1 when the loop is done.
+    int next(int32_t var, uint32_t sym) {
+        const ForFrame* frame = basic_next(env, forStack, var >= 0 ? sym : 0);
+        return frame ? frame->resume : -1;
+    }
+
+    void gosub(int resume) { gosubStack.push_back({resume, false, 0}); }
+
+    int ret() { return basic_return(env, gosubStack).resume; }
+
+    // ON INTERVAL safe point at the start of a line; true to call the handler, which
+    // returns to `resume` (the start of this line).
+    bool intervalDue(int resume) {
+        if (!basic_interval_due(env)) return false;
+        gosubStack.push_back({resume, true, env.dataPtr});
+        return true;
+    }
+
+    void onInterval(int gosubLine, const Value& ticks) { basic_on_interval(env, ticks.asNumber(), gosubLine); }
+
+    // 0 ON, 1 OFF, 2 STOP
+    void intervalCtl(int mode) { basic_interval_ctl(env, mode); }
+
+    // -------------------- Statements --------------------
+
+    static bool readLine(std::string& line) { return static_cast<bool>(std::getline(std::cin, line)); }
+
+    void input(const std::string& name, bool array, uint32_t slot, int idx, const Value* prompt) {
+        std::string_view text = prompt ? std::string_view(prompt->asString()) : std::string_view();
+        basic_assign(env, name, array, slot, idx, basic_input_value(env, text, name, readLine));
+    }
+
+    void read(const std::string& name, bool array, uint32_t slot, int idx) {
+        basic_assign(env, name, array, slot, idx, basic_read_value(env, name));
+    }
+
+    void cls() { basic_cls(env); }
+
+    // flag: bit0 row, bit1 col, bit2 cursor present
+    void locate(int flag, const Value& rowV, const Value& colV, const Value& cursorV) {
+        basic_locate(env, (flag & 1) ? static_cast<int>(rowV.asNumber()) : 1,
+                     (flag & 2) ? static_cast<int>(colV.asNumber()) : 1,
+                     (flag & 4) ? static_cast<int>(cursorV.asNumber()) : -1);
+    }
+
+    // flag: bit0 fg, bit1 bg present
+    void color(int flag, const Value& fgV, const Value& bgV) {
+        basic_color(env, (flag & 1) ? static_cast<int>(fgV.asNumber()) : -1,
+                    (flag & 2) ? static_cast<int>(bgV.asNumber()) : -1);
+    }
+
+    void randomize(bool hasSeed, const Value& seed) { basic_randomize(env, hasSeed, seed.asNumber()); }
+
+    void beep() { basic_beep(env); }
+
+    void clear() { basic_clear(env); } // FOR/GOSUB stacks are left untouched, as in the interpreter
+
+    int end() {
+        std::cout << std::flush;
+        return EXIT_SUCCESS;
+    }
+
+    int fail(const char* kind, const char* msg) {
+        std::cout << kind << " in " << line << ": " << msg << "\n" << std::flush;
+        return EXIT_FAILURE;
+    }
+};
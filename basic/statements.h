@@ -0,0 +1,256 @@
+//
+//  statements.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+// What a statement does, shared by every way a program runs: the Parser, the VM and
+// programs translated by COMPILE (runtime.h). Each engine decodes the operands and
+// keeps its own FOR/GOSUB frames, because they resume at a statement, a pc or a
+// label; a frame type only needs the members these helpers name.
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "parser.h"
+
+// -------------------- Fused assignments (VM and compiled code) --------------------
+
+// V = a op b with both operands expected to be int16. `flag` bit 0/1: the left/right
+// operand was a literal rewritten to int16, so it is widened back before the general
+// path.
+static inline void basic_store_int_op(Env& env, uint32_t slot, TokenKind op, Value lhs, Value rhs, uint8_t flag) {
+    const Env::VarSlot& v = env.vars[slot];
+    bool intTarget = v.bound ? v.type == Env::VarType::Int16
+                             : env.varTypeForName(env.varNames[slot]) == Env::VarType::Int16;
+    if (intTarget && lhs.isInt() && rhs.isInt()) {
+        env.setVar(slot, Parser::intOp(op, lhs.p.i, rhs.p.i));
+        return;
+    }
+    if (flag & 1) lhs = Value(lhs.asNumber());
+    if (flag & 2) rhs = Value(rhs.asNumber());
+    env.setVar(slot, Parser::applyOp(lhs, op, rhs));
+}
+
+// V = V + k or V = V - k (flag bit 0), in place. Bit 1: k is a whole int16.
+static inline void basic_add_var_const(Env& env, uint32_t slot, const Value& k, uint8_t flag) {
+    Env::VarSlot& v = env.vars[slot];
+    bool sub = (flag & 1) != 0;
+    if (v.bound && v.value.isDouble() && k.isNumber()) {
+        double d = k.asNumber();
+        v.value.p.d = sub ? v.value.p.d - d : v.value.p.d + d;
+        return;
+    }
+    if (v.bound && v.value.isInt() && (flag & 2)) {
+        // Exact in int32; only an out-of-range result needs the general path.
+        int32_t d = static_cast<int32_t>(k.asNumber());
+        int32_t r = sub ? v.value.p.i - d : v.value.p.i + d;
+        if (r >= -32768 && r <= 32767) {
+            v.value.p.i = static_cast<int16_t>(r);
+            return;
+        }
+    }
+    env.setVar(slot, Parser::applyOp(env.getVar(slot), sub ? TokenKind::Minus : TokenKind::Plus, k));
+}
+
+// IF V op k: the condition, without building a Value for it.
+static inline bool basic_if_var_const(Env& env, uint32_t slot, TokenKind op, const Value& k) {
+    const Env::VarSlot& v = env.vars[slot];
+    if (v.bound && v.value.isNumber() && k.isNumber()) {
+        return Parser::compareOp(op, v.value.asNumber(), k.asNumber()).p.i != 0;
+    }
+    return Parser::applyOp(env.getVar(slot), op, k).asNumber() != 0.0;
+}
+
+// -------------------- FOR / NEXT / RETURN --------------------
+
+// FOR var = start TO end [STEP step]: assigns the start value and returns the counter
+// for the frame the caller pushes with basic_push_for.
+static inline Env::ForCounter basic_for_start(Env& env, uint32_t var, double start, double end,
+                                              double step, bool hasStep) {
+    if (hasStep && step == 0.0) throw RuntimeError("STEP cannot be 0");
+    env.setVar(var, Value(start));
+    return env.makeForCounter(var, end, step);
+}
+
+// GW-BASIC semantics: remove any existing FOR with the same control variable.
+template <typename Frame>
+static inline void basic_push_for(std::vector<Frame>& stack, const Frame& frame) {
+    for (size_t i = stack.size(); i-- > 0;) {
+        if (stack[i].sym == frame.sym) {
+            stack.erase(stack.begin() + static_cast<std::ptrdiff_t>(i), stack.end());
+            break;
+        }
+    }
+    stack.push_back(frame);
+}
+
+// NEXT [var] (sym 0: the innermost loop) steps the loop it names. Returns its frame
+// while the loop goes on, or nullptr once it is done and popped.
+template <typename Frame>
+static inline const Frame* basic_next(Env& env, std::vector<Frame>& stack, uint32_t sym) {
+    if (stack.empty()) throw RuntimeError("NEXT without FOR");
+
+    // NEXT nearly always closes the innermost loop; search only otherwise.
+    if (sym && stack.back().sym != sym) {
+        size_t i = stack.size() - 1;
+        while (i > 0 && stack[i - 1].sym != sym) --i;
+        if (i == 0) throw RuntimeError("NEXT without FOR");
+        // Drop any inner FORs above the matched one (GOTO can jump out of inner loops).
+        stack.resize(i);
+    }
+
+    const Frame& frame = stack.back();
+    if (env.stepFor(frame.var, frame.counter)) return &frame;
+    stack.pop_back();
+    return nullptr;
+}
+
+// RETURN: pops the innermost GOSUB frame. Leaving the ON INTERVAL handler puts back
+// the DATA pointer it interrupted and lets the timer fire again.
+template <typename Frame>
+static inline Frame basic_return(Env& env, std::vector<Frame>& stack) {
+    if (stack.empty()) throw RuntimeError("RETURN without GOSUB");
+    Frame fr = stack.back();
+    stack.pop_back();
+    if (fr.isInterval) {
+        env.dataPtr = fr.savedDataPtr;
+        env.inIntervalISR = false;
+    }
+    return fr;
+}
+
+// -------------------- ON INTERVAL --------------------
+
+// A handler is set, enabled and not already running.
+static inline bool basic_interval_active(const Env& env) {
+    return env.intervalEnabled && env.intervalArmed && !env.inIntervalISR &&
+           env.intervalSeconds > 0.0 && env.intervalGosubLine > 0;
+}
+
+// Safe point between lines: true if the handler is due. The next tick is scheduled
+// and the handler marked running; the caller pushes a GOSUB frame with isInterval
+// and env.dataPtr, then jumps to env.intervalGosubLine.
+static inline bool basic_interval_due(Env& env) {
+    if (!basic_interval_active(env)) return false;
+    auto now = std::chrono::steady_clock::now();
+    if (now < env.nextIntervalFire) return false;
+    env.nextIntervalFire = now + std::chrono::milliseconds(static_cast<int>(env.intervalSeconds * 1000.0));
+    env.inIntervalISR = true;
+    return true;
+}
+
+// ON INTERVAL ticks GOSUB line (ticks of 1/60 s). Arms the timer from now; INTERVAL
+// ON/OFF still decides whether it fires.
+static inline void basic_on_interval(Env& env, double ticks, int gosubLine) {
+    env.intervalSeconds = ticks / 60.0;
+    env.intervalGosubLine = gosubLine;
+    env.intervalArmed = true;
+    auto now = std::chrono::steady_clock::now();
+    env.nextIntervalFire = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(std::max(0.0, env.intervalSeconds))
+    );
+}
+
+// INTERVAL ON (0), OFF (1, keeps the settings) or STOP (2, also disarms).
+static inline void basic_interval_ctl(Env& env, int mode) {
+    if (mode == 0) {
+        env.intervalEnabled = true;
+        if (env.intervalArmed && env.intervalSeconds > 0.0) {
+            auto now = std::chrono::steady_clock::now();
+            env.nextIntervalFire = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(env.intervalSeconds)
+            );
+        }
+        return;
+    }
+    env.intervalEnabled = false;
+    if (mode == 2) env.intervalArmed = false;
+}
+
+// -------------------- INPUT / READ --------------------
+
+// Stores into a scalar (`slot`) or an array element (`name`(idx)).
+static inline void basic_assign(Env& env, const std::string& name, bool isArray, uint32_t slot, int idx,
+                                const Value& v) {
+    if (isArray) env.setArrayElem(name, idx, v);
+    else env.setVar(slot, v);
+}
+
+// INPUT: shows the prompt ("? " if there is none), reads a line with `readLine` and
+// converts it for `name`: the text for a $ name, otherwise its leading number.
+static inline Value basic_input_value(Env& env, std::string_view prompt, const std::string& name,
+                                      bool (*readLine)(std::string&)) {
+    basic_print_string(env, prompt.empty() ? std::string_view("? ") : prompt);
+
+    std::string line;
+    if (!readLine(line)) throw RuntimeError("Input aborted");
+    line = trim(line);
+    // INPUT is line-oriented: once the user submits, output continues on the next line.
+    basic_print_char(env, '\n');
+
+    if (!name.empty() && name.back() == '$') return Value(std::move(line));
+    char* end = nullptr;
+    double d = std::strtod(line.c_str(), &end);
+    if (end == line.c_str()) d = 0.0;
+    return Value(d);
+}
+
+// READ: the next DATA item, as a string for a $ name.
+static inline Value basic_read_value(Env& env, const std::string& name) {
+    bool wantString = (!name.empty() && name.back() == '$');
+    return env.readNextData(wantString, env.program);
+}
+
+// -------------------- Screen and misc --------------------
+
+static inline void basic_cls(Env& env) {
+    if (env.screen.cls) env.screen.cls();
+    env.printCol = 0;
+}
+
+// LOCATE row, col[, cursor]: 1-based, clamped to 1; cursor 0 hides, 1 shows and
+// anything else leaves it alone.
+static inline void basic_locate(Env& env, int row, int col, int cursor) {
+    if (row < 1) row = 1;
+    if (col < 1) col = 1;
+    if (cursor == 0) {
+        if (env.screen.showCursor) env.screen.showCursor(false);
+    } else if (cursor == 1) {
+        if (env.screen.showCursor) env.screen.showCursor(true);
+    }
+    if (env.screen.locate) env.screen.locate(row, col);
+    env.printCol = col - 1;
+}
+
+// COLOR fg, bg: -1 for a missing one; others are capped at 15.
+static inline void basic_color(Env& env, int fg, int bg) {
+    if (!env.screen.color) return;
+    if (fg > 15) fg = 15;
+    if (bg > 15) bg = 15;
+    env.screen.color(fg, bg);
+}
+
+// RANDOMIZE [seed]: without a seed, the current time.
+static inline void basic_randomize(Env& env, bool hasSeed, double seed) {
+    std::srand(hasSeed ? static_cast<unsigned>(static_cast<long long>(seed))
+                       : static_cast<unsigned>(std::time(nullptr)));
+    env.hasLastRnd = false;
+}
+
+static inline void basic_beep(Env& env) {
+    if (env.screen.beep) env.screen.beep();
+    else std::cout << '\a' << std::flush;
+}
+
+// CLEAR: variables, arrays and DATA position. Many GW-BASIC programs use CLEAR n as
+// a memory-tuning hint, so FOR/GOSUB stacks and ON INTERVAL state are kept.
+static inline void basic_clear(Env& env) {
+    env.clearVars();
+}
@@ -31,7 +31,7 @@ static inline bool istartswith(const std::string& s, const std::string& pfx) {
     return true;
 }
 
-static inline std::string upper_ascii(const std::string& s) {
+static inline std::string upper_ascii(std::string_view s) {
     std::string u; u.reserve(s.size());
     for (char c : s) u.push_back(std::toupper(static_cast<unsigned char>(c)));
     return u;
@@ -7,6 +7,11 @@
 
 #pragma once
 
+#include <string>
+#include <string_view>
+#include <array>
+#include <cstdint>
+
 enum class TokenKind {
     End,
     Number,
@@ -43,10 +48,99 @@ enum class TokenKind {
 
 struct Token {
     TokenKind kind;
-    std::string text;
+    // Identifier name or String literal body (doubled quotes kept), viewing the source
+    // line, which must outlive the token; empty for numbers, operators and keywords.
+    std::string_view text;
     double number = 0.0;
+    // Source span [start, end) within the line; only filled in for stored program lines.
+    uint32_t start = 0;
+    uint32_t end = 0;
+    // Interned upper-cased identifier (Env::symbolNames); 0 = not interned.
+    uint32_t sym = 0;
+    // Scalar variable slot for this identifier (Env::varNames); 0 = not resolved.
+    uint32_t var = 0;
+    // Builtin function ID (builtins.h) when the identifier names one; 0 = none.
+    uint8_t fn = 0;
+
+    // The text as a string: a String literal's value ("" undoubled) or an identifier.
+    std::string str() const {
+        if (kind != TokenKind::String || text.find('"') == std::string_view::npos) return std::string(text);
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            out.push_back(text[i]);
+            if (text[i] == '"') ++i;
+        }
+        return out;
+    }
 };
 
+// -------------------- Keyword recognition --------------------
+
+struct KeywordEntry {
+    std::string_view word; // upper-case spelling
+    TokenKind kind;
+};
+
+inline constexpr KeywordEntry kKeywords[] = {
+    {"PRINT", TokenKind::KW_PRINT}, {"LET", TokenKind::KW_LET}, {"INPUT", TokenKind::KW_INPUT},
+    {"IF", TokenKind::KW_IF}, {"THEN", TokenKind::KW_THEN}, {"GOTO", TokenKind::KW_GOTO},
+    {"GOSUB", TokenKind::KW_GOSUB}, {"RETURN", TokenKind::KW_RETURN}, {"FOR", TokenKind::KW_FOR},
+    {"TO", TokenKind::KW_TO}, {"STEP", TokenKind::KW_STEP}, {"NEXT", TokenKind::KW_NEXT},
+    {"END", TokenKind::KW_END}, {"STOP", TokenKind::KW_STOP}, {"REM", TokenKind::KW_REM},
+    {"DIM", TokenKind::KW_DIM}, {"AND", TokenKind::KW_AND}, {"OR", TokenKind::KW_OR},
+    {"NOT", TokenKind::KW_NOT}, {"MOD", TokenKind::KW_MOD}, {"CLS", TokenKind::KW_CLS},
+    {"LOCATE", TokenKind::KW_LOCATE}, {"COLOR", TokenKind::KW_COLOR}, {"ON", TokenKind::KW_ON},
+    {"INTERVAL", TokenKind::KW_INTERVAL}, {"OFF", TokenKind::KW_OFF}, {"DEFINT", TokenKind::KW_DEFINT},
+    {"KEY", TokenKind::KW_KEY}, {"READ", TokenKind::KW_READ}, {"DATA", TokenKind::KW_DATA},
+    {"RESTORE", TokenKind::KW_RESTORE}, {"RANDOMIZE", TokenKind::KW_RANDOMIZE}, {"BEEP", TokenKind::KW_BEEP},
+    {"RUN", TokenKind::KW_RUN}, {"LIST", TokenKind::KW_LIST}, {"NEW", TokenKind::KW_NEW},
+    {"CLEAR", TokenKind::KW_CLEAR}, {"DELETE", TokenKind::KW_DELETE}, {"CONT", TokenKind::KW_CONT},
+    {"SAVE", TokenKind::KW_SAVE}, {"LOAD", TokenKind::KW_LOAD},
+};
+
+constexpr char keyword_upper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// Perfect hash over kKeywords: every keyword lands in its own bucket (checked by the
+// static_assert below), so a lookup is one hash plus one compare. Needs s.size() >= 2.
+constexpr unsigned keyword_hash(std::string_view s) {
+    auto c = [&](size_t i) { return static_cast<unsigned>(static_cast<unsigned char>(keyword_upper(s[i]))); };
+    size_t n = s.size();
+    return (3u * c(0) + 30u * c(1) + 34u * c(n - 2) + c(n - 1) + static_cast<unsigned>(n)) & 127u;
+}
+
+constexpr std::array<int8_t, 128> make_keyword_table() {
+    std::array<int8_t, 128> t{};
+    for (auto& e : t) e = -1;
+    for (size_t i = 0; i < std::size(kKeywords); ++i) t[keyword_hash(kKeywords[i].word)] = static_cast<int8_t>(i);
+    return t;
+}
+
+inline constexpr std::array<int8_t, 128> kKeywordTable = make_keyword_table();
+
+constexpr bool keyword_table_is_perfect() {
+    for (size_t i = 0; i < std::size(kKeywords); ++i) {
+        if (kKeywordTable[keyword_hash(kKeywords[i].word)] != static_cast<int8_t>(i)) return false;
+    }
+    return true;
+}
+static_assert(keyword_table_is_perfect(), "keyword hash collision: pick new multipliers");
+
+// Keyword kind of an identifier spelled in any case, or TokenKind::Identifier.
+constexpr TokenKind keyword_kind(std::string_view s) {
+    if (s.size() < 2 || s.size() > 9) return TokenKind::Identifier;
+    int8_t e = kKeywordTable[keyword_hash(s)];
+    if (e < 0) return TokenKind::Identifier;
+    std::string_view w = kKeywords[e].word;
+    if (w.size() != s.size()) return TokenKind::Identifier;
+    for (size_t i = 0; i < s.size(); ++i) {
+        if (keyword_upper(s[i]) != w[i]) return TokenKind::Identifier;
+    }
+    return kKeywords[e].kind;
+}
+
 static inline bool is_basic_keyword(TokenKind k) {
     switch (k) {
         case TokenKind::KW_PRINT: case TokenKind::KW_LET: case TokenKind::KW_INPUT:
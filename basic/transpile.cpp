@@ -0,0 +1,461 @@
+//
+//  transpile.cpp
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "transpile.h"
+
+void Transpiler::write(std::ostream& out) {
+    scan();
+
+    out << "// Generated by COMPILE from a BASIC program. Build it against the interpreter sources:\n"
+        << "//   c++ -std=gnu++20 -O2 -iquote <basic> prog.cpp <basic>/builtins.cpp -o prog\n\n"
+        << "#include \"runtime.h\"\n\n";
+
+    out << "static const char* const kVarNames[] = {";
+    for (size_t i = 0; i < env.varNames.size(); ++i) out << (i ? ", " : "") << quoted(env.varNames[i]);
+    out << "};\n";
+
+    // READ only needs the lines that hold DATA.
+    std::vector<std::pair<int, const std::string*>> data;
+    for (const auto& [ln, line] : env.program) {
+        if (upper_ascii(line.text).find("DATA") != std::string::npos) data.push_back({ln, &line.text});
+    }
+    if (!data.empty()) {
+        out << "static const BasicRuntime::DataLine kData[] = {\n";
+        for (const auto& [ln, text] : data) out << "    {" << ln << ", " << quoted(*text) << "},\n";
+        out << "};\n";
+    }
+    if (!prog.names.empty()) {
+        out << "static const std::string kArrays[] = {";
+        for (size_t i = 0; i < prog.names.size(); ++i) out << (i ? ", " : "") << quoted(prog.names[i]);
+        out << "};\n";
+    }
+
+    out << "\nint main() {\n"
+        << "    BasicRuntime rt(kVarNames, std::size(kVarNames), "
+        << (data.empty() ? "nullptr, 0" : "kData, std::size(kData)") << ");\n"
+        << "    Env& env = rt.env;\n";
+    // Made after the Env, like every Value the program touches.
+    if (!prog.consts.empty()) {
+        out << "    const Value kC[] = {\n";
+        for (const Value& v : prog.consts) out << "        " << constant(v) << ",\n";
+        out << "    };\n";
+    }
+    if (usesDispatch) out << "    int resume = 0;\n";
+    if (usesInterval) out << "    int target = 0;\n";
+    out << "\n    try {\n";
+
+    for (uint32_t pc = 0; pc < prog.code.size(); ++pc) {
+        if (labelled[pc]) {
+            closeIfIdle(out);
+            out << "    L" << pc << ":\n";
+        }
+        statement(out, pc);
+    }
+
+    if (usesDispatch) {
+        out << "    dispatch:\n"
+            << "        switch (resume) {\n";
+        for (size_t i = 0; i < resumePcs.size(); ++i) {
+            out << "            case " << i << ": goto L" << resumePcs[i] << ";\n";
+        }
+        out << "            default: break;\n"
+            << "        }\n"
+            << "        return rt.end();\n";
+    }
+    if (usesInterval) {
+        std::vector<std::pair<int, uint32_t>> lines(prog.lineStart.begin(), prog.lineStart.end());
+        std::sort(lines.begin(), lines.end());
+        out << "    to_line:\n"
+            << "        switch (target) {\n";
+        for (const auto& [ln, pc] : lines) out << "            case " << ln << ": goto L" << pc << ";\n";
+        out << "            default: break;\n"
+            << "        }\n"
+            << "        throw RuntimeError(\"Undefined line number\");\n";
+    }
+
+    out << "    } catch (const RuntimeError& e) {\n"
+        << "        return rt.fail(\"Runtime error\", e.what());\n"
+        << "    } catch (const ParseError& e) {\n"
+        << "        return rt.fail(\"Syntax error\", e.what());\n"
+        << "    }\n"
+        << "}\n";
+}
+
+// Labels go on jump targets and resume points only; with ON INTERVAL every line can be
+// both the handler and the place it returns to.
+void Transpiler::scan() {
+    const auto& code = prog.code;
+    labelled.assign(code.size() + 1, false);
+    resumeId.clear();
+    resumePcs.clear();
+    stack.clear();
+    temps = 0;
+    usesInterval = std::any_of(code.begin(), code.end(), [](const Instr& in) { return in.op == Op::OnInterval; });
+    usesDispatch = usesInterval;
+
+    for (uint32_t pc = 0; pc < code.size(); ++pc) {
+        const Instr& in = code[pc];
+        switch (in.op) {
+            case Op::Jump:
+            case Op::JumpIfFalse:
+                labelled[static_cast<size_t>(in.a)] = true;
+                break;
+            case Op::IfVarConst:
+                labelled[pc + 2] = true;
+                break;
+            case Op::Gosub:
+                labelled[static_cast<size_t>(in.a)] = true;
+                resumeFor(pc + 1);
+                break;
+            case Op::ForInit:
+                resumeFor(pc + 1);
+                break;
+            case Op::Next:
+            case Op::Return:
+                usesDispatch = true;
+                break;
+            case Op::Line:
+                if (usesInterval) resumeFor(pc);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+int Transpiler::resumeFor(uint32_t pc) {
+    auto it = resumeId.find(pc);
+    if (it != resumeId.end()) return it->second;
+    int id = static_cast<int>(resumePcs.size());
+    resumePcs.push_back(pc);
+    resumeId.emplace(pc, id);
+    labelled[pc] = true;
+    return id;
+}
+
+// One instruction. Stack operands are C++ expressions: constants are used in place,
+// anything else is a temporary declared in a block that closes with the statement, so
+// the labels between statements never skip an initialization.
+void Transpiler::statement(std::ostream& out, uint32_t pc) {
+    const Instr& in = prog.code[pc];
+    auto ind = [&]() -> std::ostream& { return out << (temps == 0 ? "        " : "            "); };
+    auto slot = [&]() { return std::to_string(in.a); };
+    auto arrayName = [&]() { return "kArrays[" + std::to_string(in.a) + "]"; };
+    auto goTo = [&](int32_t target) { return "goto L" + std::to_string(target) + ";"; };
+
+    switch (in.op) {
+        case Op::Line:
+            ind() << "rt.line = " << in.a << ";\n";
+            if (usesInterval) {
+                ind() << "if (rt.intervalDue(" << resumeFor(pc)
+                      << ")) { target = env.intervalGosubLine; goto to_line; }\n";
+            }
+            break;
+
+        case Op::PushConst:
+            stack.push_back("kC[" + std::to_string(in.a) + "]");
+            break;
+
+        case Op::LoadVar:
+            push(out, "env.getVar(" + slot() + ")");
+            break;
+
+        case Op::StoreVar: {
+            std::string v = pop();
+            ind() << "env.setVar(" << slot() << ", " << v << ");\n";
+            break;
+        }
+
+        case Op::StoreIntOp: {
+            std::string rhs = pop(), lhs = pop();
+            ind() << "rt.storeIntOp(" << slot() << ", " << opName(in.b) << ", " << lhs << ", " << rhs
+                  << ", " << static_cast<int>(in.flag) << ");\n";
+            break;
+        }
+
+        case Op::AddVarConst:
+            ind() << "rt.addVarConst(" << slot() << ", kC[" << in.b << "], " << static_cast<int>(in.flag) << ");\n";
+            break;
+
+        case Op::AppendVar: {
+            std::vector<std::string> pieces(static_cast<size_t>(in.b));
+            for (size_t i = pieces.size(); i-- > 0;) pieces[i] = pop();
+            for (const std::string& p : pieces) ind() << "env.appendToVar(" << slot() << ", " << p << ".asString());\n";
+            break;
+        }
+
+        case Op::LoadElem: {
+            std::string idx = pop();
+            push(out, "env.getArrayElem(" + arrayName() + ", static_cast<int>(" + idx + ".asNumber()))");
+            break;
+        }
+
+        case Op::StoreElem: {
+            std::string v = pop(), idx = pop();
+            ind() << "env.setArrayElem(" << arrayName() << ", static_cast<int>(" << idx << ".asNumber()), " << v << ");\n";
+            break;
+        }
+
+        case Op::BinOp:
+        case Op::BinI:
+        case Op::BinN: {
+            std::string rhs = pop(), lhs = pop();
+            const char* fn = in.op == Op::BinI ? "rt.binI(" : in.op == Op::BinN ? "rt.binN(" : nullptr;
+            if (fn) push(out, fn + opName(in.a) + ", " + lhs + ", " + rhs + ")");
+            else push(out, "Parser::applyOp(" + lhs + ", " + opName(in.a) + ", " + rhs + ")");
+            break;
+        }
+
+        case Op::Neg:
+            push(out, "Parser::negate(" + pop() + ")");
+            break;
+
+        case Op::Not:
+            push(out, "Parser::logicalNot(" + pop() + ")");
+            break;
+
+        case Op::Call: {
+            std::vector<std::string> args(static_cast<size_t>(in.b));
+            for (size_t i = args.size(); i-- > 0;) args[i] = pop();
+            if (args.empty()) {
+                push(out, "call_builtin(env, " + std::to_string(in.a) + ", nullptr, 0)");
+                break;
+            }
+            std::string list = "a" + std::to_string(temps);
+            std::string init;
+            for (size_t i = 0; i < args.size(); ++i) init += (i ? ", " : "") + args[i];
+            if (temps == 0) out << "        {\n";
+            ++temps;
+            out << "            const Value " << list << "[] = {" << init << "};\n";
+            push(out, "call_builtin(env, " + std::to_string(in.a) + ", " + list + ", " + std::to_string(args.size()) + ")");
+            break;
+        }
+
+        case Op::Pop:
+            pop();
+            break;
+
+        case Op::Print:
+        case Op::PrintLine: {
+            std::string v = pop();
+            ind() << "basic_print_value(env, " << v << ");\n";
+            if (in.op == Op::PrintLine) ind() << "basic_print_char(env, '\\n');\n";
+            break;
+        }
+
+        case Op::PrintTab:
+            ind() << "basic_print_tab_to_next_stop(env);\n";
+            break;
+
+        case Op::PrintChar:
+            ind() << "basic_print_char(env, static_cast<char>(" << in.a << "));\n";
+            break;
+
+        case Op::Jump:
+            ind() << goTo(in.a) << "\n";
+            break;
+
+        case Op::JumpIfFalse: {
+            std::string cond = pop();
+            ind() << "if (!rt.truthy(" << cond << ")) " << goTo(in.a) << "\n";
+            break;
+        }
+
+        case Op::IfVarConst:
+            ind() << "if (!rt.ifVarConst(" << slot() << ", " << opName(in.flag) << ", kC[" << in.b << "])) "
+                  << goTo(static_cast<int32_t>(pc + 2)) << "\n";
+            break;
+
+        case Op::Gosub:
+            ind() << "rt.gosub(" << resumeFor(pc + 1) << ");\n";
+            ind() << goTo(in.a) << "\n";
+            break;
+
+        case Op::Return:
+            ind() << "resume = rt.ret();\n";
+            ind() << "goto dispatch;\n";
+            break;
+
+        case Op::ForInit: {
+            std::string step = pop(), end = pop(), start = pop();
+            ind() << "rt.forInit(" << slot() << ", " << in.b << ", " << start << ", " << end << ", " << step << ", "
+                  << (in.flag ? "true" : "false") << ", " << resumeFor(pc + 1) << ");\n";
+            break;
+        }
+
+        case Op::Next:
+            ind() << "resume = rt.next(" << in.a << ", " << in.b << ");\n";
+            ind() << "if (resume >= 0) goto dispatch;\n";
+            break;
+
+        case Op::End:
+        case Op::Halt:
+            ind() << "return rt.end();\n";
+            break;
+
+        case Op::Dim: {
+            std::string ub = pop();
+            ind() << "env.dimArray(" << arrayName() << ", static_cast<int>(" << ub << ".asNumber()));\n";
+            break;
+        }
+
+        case Op::Input:
+        case Op::Read: {
+            std::string idx = in.flag ? "static_cast<int>(" + pop() + ".asNumber())" : "0";
+            std::string name = in.flag ? arrayName() : "env.varNames[" + slot() + "]";
+            std::string target = (in.flag ? "true, 0, " : "false, " + slot() + ", ") + idx;
+            if (in.op == Op::Read) {
+                ind() << "rt.read(" << name << ", " << target << ");\n";
+            } else {
+                std::string prompt = in.b >= 0 ? "&kC[" + std::to_string(in.b) + "]" : "nullptr";
+                ind() << "rt.input(" << name << ", " << target << ", " << prompt << ");\n";
+            }
+            break;
+        }
+
+        case Op::Restore:
+            ind() << "env.restoreData(" << in.a << ", env.program);\n";
+            break;
+
+        case Op::Cls:
+            ind() << "rt.cls();\n";
+            break;
+
+        case Op::Locate: {
+            std::string cursor = (in.flag & 4) ? pop() : "Value()";
+            std::string col = (in.flag & 2) ? pop() : "Value()";
+            std::string row = (in.flag & 1) ? pop() : "Value()";
+            ind() << "rt.locate(" << static_cast<int>(in.flag) << ", " << row << ", " << col << ", " << cursor << ");\n";
+            break;
+        }
+
+        case Op::Color: {
+            std::string bg = (in.flag & 2) ? pop() : "Value()";
+            std::string fg = (in.flag & 1) ? pop() : "Value()";
+            ind() << "rt.color(" << static_cast<int>(in.flag) << ", " << fg << ", " << bg << ");\n";
+            break;
+        }
+
+        case Op::Randomize: {
+            std::string seed = in.flag ? pop() : "Value()";
+            ind() << "rt.randomize(" << (in.flag ? "true" : "false") << ", " << seed << ");\n";
+            break;
+        }
+
+        case Op::Beep:
+            for (int i = 0; i < in.flag; ++i) pop();
+            ind() << "rt.beep();\n";
+            break;
+
+        case Op::OnInterval: {
+            std::string ticks = pop();
+            ind() << "rt.onInterval(" << in.a << ", " << ticks << ");\n";
+            break;
+        }
+
+        case Op::IntervalCtl:
+            ind() << "rt.intervalCtl(" << static_cast<int>(in.flag) << ");\n";
+            break;
+
+        case Op::DefInt:
+            ind() << "env.setDefIntRange('" << static_cast<char>(in.a) << "', '" << static_cast<char>(in.b) << "', true);\n";
+            break;
+
+        case Op::Clear:
+            if (in.flag) pop();
+            ind() << "rt.clear();\n";
+            break;
+
+        case Op::Raise:
+            ind() << "throw " << (in.flag ? "ParseError" : "RuntimeError") << "(kC[" << in.a << "].asString());\n";
+            // A compile error can cut a statement short; whatever it had pushed is dead.
+            stack.clear();
+            break;
+    }
+    closeIfIdle(out);
+}
+
+std::string Transpiler::push(std::ostream& out, const std::string& expr) {
+    if (temps == 0) out << "        {\n";
+    std::string t = "t" + std::to_string(temps++);
+    out << "            Value " << t << " = " << expr << ";\n";
+    stack.push_back(t);
+    return t;
+}
+
+std::string Transpiler::pop() {
+    std::string v = std::move(stack.back());
+    stack.pop_back();
+    return v;
+}
+
+void Transpiler::closeIfIdle(std::ostream& out) {
+    if (!stack.empty()) return;
+    if (temps > 0) out << "        }\n";
+    temps = 0;
+}
+
+std::string Transpiler::constant(const Value& v) const {
+    if (v.isInt()) return "Value(static_cast<int16_t>(" + std::to_string(v.p.i) + "))";
+    if (v.isDouble()) {
+        double d = v.p.d;
+        if (std::isnan(d)) return "Value(std::numeric_limits<double>::quiet_NaN())";
+        if (std::isinf(d)) return d < 0 ? "Value(-std::numeric_limits<double>::infinity())"
+                                        : "Value(std::numeric_limits<double>::infinity())";
+        // Hex float literals round-trip exactly.
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%a", d);
+        return std::string("Value(") + buf + ")";
+    }
+    std::string s = v.asString();
+    if (s.find('\0') != std::string::npos) {
+        return "Value::literal(std::string(" + quoted(s) + ", " + std::to_string(s.size()) + "))";
+    }
+    return "Value::literal(" + quoted(s) + ")";
+}
+
+std::string Transpiler::quoted(const std::string& s) {
+    std::string r = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+            r += static_cast<char>(c);
+        } else if (c < 32 || c >= 127) {
+            // Always three octal digits, so a following digit is never absorbed.
+            char buf[5];
+            std::snprintf(buf, sizeof(buf), "\\%03o", c);
+            r += buf;
+        } else {
+            r += static_cast<char>(c);
+        }
+    }
+    return r + "\"";
+}
+
+std::string Transpiler::opName(int32_t kind) {
+    switch (static_cast<TokenKind>(kind)) {
+        case TokenKind::Plus:         return "TokenKind::Plus";
+        case TokenKind::Minus:        return "TokenKind::Minus";
+        case TokenKind::Star:         return "TokenKind::Star";
+        case TokenKind::Slash:        return "TokenKind::Slash";
+        case TokenKind::Backslash:    return "TokenKind::Backslash";
+        case TokenKind::Caret:        return "TokenKind::Caret";
+        case TokenKind::Equal:        return "TokenKind::Equal";
+        case TokenKind::Less:         return "TokenKind::Less";
+        case TokenKind::Greater:      return "TokenKind::Greater";
+        case TokenKind::NotEqual:     return "TokenKind::NotEqual";
+        case TokenKind::LessEqual:    return "TokenKind::LessEqual";
+        case TokenKind::GreaterEqual: return "TokenKind::GreaterEqual";
+        case TokenKind::KW_AND:       return "TokenKind::KW_AND";
+        case TokenKind::KW_OR:        return "TokenKind::KW_OR";
+        case TokenKind::KW_MOD:       return "TokenKind::KW_MOD";
+        default:                      return "static_cast<TokenKind>(" + std::to_string(kind) + ")";
+    }
+}
@@ -0,0 +1,50 @@
+//
+//  transpile.h
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "bytecode.h"
+
+// Ahead-of-time translation to C++ (COMPILE "file.cpp", --compile=file.cpp). The
+// input is the Compiler's bytecode, so the output has exactly the VM's semantics:
+// every instruction becomes a call into runtime.h on named temporaries, evaluated in
+// the same order. Line starts and jump targets become labels and GOTO a goto. NEXT
+// and RETURN resume through one switch over the FOR and GOSUB return points, and
+// ON INTERVAL handlers through a switch over line numbers.
+struct Transpiler {
+    const Env& env;
+    const CompiledProgram& prog;
+
+    Transpiler(const Env& e, const CompiledProgram& p) : env(e), prog(p) {}
+
+    void write(std::ostream& out);
+
+private:
+    std::vector<bool> labelled;                 // per pc: needs a label
+    std::unordered_map<uint32_t, int> resumeId; // pc -> case in the resume switch
+    std::vector<uint32_t> resumePcs;
+    bool usesInterval = false;
+    bool usesDispatch = false;
+
+    std::vector<std::string> stack; // C++ expression for each bytecode stack entry
+    int temps = 0;
+
+    void scan();
+    int resumeFor(uint32_t pc);
+    void statement(std::ostream& out, uint32_t pc);
+
+    std::string push(std::ostream& out, const std::string& expr);
+    std::string pop();
+    void closeIfIdle(std::ostream& out);
+
+    std::string constant(const Value& v) const;
+    static std::string quoted(const std::string& s);
+    static std::string opName(int32_t kind);
+};
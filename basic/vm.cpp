@@ -0,0 +1,360 @@
+//
+//  vm.cpp
+//  basic
+//
+//  Created by Emídio Cunha on 16/10/2026.
+//
+
+#include "bytecode.h"
+#include "interpreter.h"
+#include "jit.h"
+#include "statements.h"
+
+// Pops the n topmost values, in push order.
+static std::vector<Value> vm_pop_args(std::vector<Value>& stack, size_t n) {
+    std::vector<Value> args(std::make_move_iterator(stack.end() - static_cast<std::ptrdiff_t>(n)),
+                            std::make_move_iterator(stack.end()));
+    stack.resize(stack.size() - n);
+    return args;
+}
+
+static Value vm_pop(std::vector<Value>& stack) {
+    Value v = std::move(stack.back());
+    stack.pop_back();
+    return v;
+}
+
+// Every handler ends in VM_NEXT(). With GCC and Clang that is direct threading
+// (labels as values): each handler fetches the next instruction and jumps straight
+// to its handler, so every opcode gets its own indirect branch to predict. Other
+// compilers, or -DBASIC_VM_NO_THREADING, get the same handlers as a switch loop.
+#if (defined(__GNUC__) || defined(__clang__)) && !defined(BASIC_VM_NO_THREADING)
+#define BASIC_VM_THREADED 1
+#define VM_OP(name) op_##name:
+#define VM_NEXT() do { at = pc; in = &code[pc++]; goto *dispatch[static_cast<size_t>(in->op)]; } while (0)
+#else
+#define BASIC_VM_THREADED 0
+#define VM_OP(name) case Op::name:
+#define VM_NEXT() continue
+#endif
+
+VM::Status VM::run(Env& env, const CompiledProgram& prog, std::atomic<bool>& breakRequested) {
+    const Instr* code = prog.code.data();
+    const Instr* in = code;
+    uint32_t at = pc;
+
+    // Ctrl+C: leave pc on a resumable instruction so CONT picks up from there.
+    auto takeBreak = [&]() -> bool {
+        if (!breakRequested.load(std::memory_order_relaxed)) return false;
+        if (!breakRequested.exchange(false, std::memory_order_relaxed)) return false;
+        std::cout << "\nBreak\n";
+        env.running = false;
+        env.stopped = false;
+        env.contAvailable = true;
+        return true;
+    };
+
+    auto jumpToLine = [&](int line) {
+        auto it = prog.lineStart.find(line);
+        if (it == prog.lineStart.end()) throw RuntimeError("Undefined line number");
+        pc = it->second;
+    };
+
+    try {
+#if BASIC_VM_THREADED
+        // Same order as Op.
+        static const void* const dispatch[] = {
+            &&op_Line, &&op_PushConst, &&op_LoadVar, &&op_StoreVar, &&op_StoreIntOp,
+            &&op_AddVarConst, &&op_AppendVar, &&op_LoadElem, &&op_StoreElem, &&op_BinOp,
+            &&op_BinI, &&op_BinN, &&op_Neg, &&op_Not, &&op_Call, &&op_Pop, &&op_Print,
+            &&op_PrintLine, &&op_PrintTab, &&op_PrintChar, &&op_Jump, &&op_JumpIfFalse,
+            &&op_IfVarConst, &&op_Gosub, &&op_Return, &&op_ForInit, &&op_Next, &&op_End,
+            &&op_Dim, &&op_Input, &&op_Read, &&op_Restore, &&op_Cls, &&op_Locate, &&op_Color,
+            &&op_Randomize, &&op_Beep, &&op_OnInterval, &&op_IntervalCtl, &&op_DefInt,
+            &&op_Clear, &&op_Raise, &&op_Halt
+        };
+        static_assert(sizeof(dispatch) / sizeof(dispatch[0]) == static_cast<size_t>(Op::Halt) + 1,
+                      "one handler per Op");
+        VM_NEXT();
+#else
+        while (true) {
+            at = pc;
+            in = &code[pc++];
+
+            switch (in->op) {
+#endif
+                VM_OP(Line) {
+                    if (takeBreak()) { pc = at; return Status::Break; }
+
+                    // ON INTERVAL safe point: the handler returns to the start of this line.
+                    if (basic_interval_due(env)) {
+                        gosubStack.push_back({at, true, env.dataPtr});
+                        jumpToLine(env.intervalGosubLine);
+                    }
+                    VM_NEXT();
+                }
+
+                VM_OP(PushConst)
+                    stack.push_back(prog.consts[static_cast<size_t>(in->a)]);
+                    VM_NEXT();
+
+                VM_OP(LoadVar)
+                    stack.push_back(env.getVar(static_cast<uint32_t>(in->a)));
+                    VM_NEXT();
+
+                VM_OP(StoreVar)
+                    env.setVar(static_cast<uint32_t>(in->a), stack.back());
+                    stack.pop_back();
+                    VM_NEXT();
+
+                VM_OP(StoreIntOp) {
+                    Value rhs = vm_pop(stack);
+                    Value lhs = vm_pop(stack);
+                    basic_store_int_op(env, static_cast<uint32_t>(in->a), static_cast<TokenKind>(in->b),
+                                       std::move(lhs), std::move(rhs), in->flag);
+                    VM_NEXT();
+                }
+
+                VM_OP(AddVarConst)
+                    basic_add_var_const(env, static_cast<uint32_t>(in->a), prog.consts[static_cast<size_t>(in->b)], in->flag);
+                    VM_NEXT();
+
+                VM_OP(AppendVar) {
+                    auto pieces = vm_pop_args(stack, static_cast<size_t>(in->b));
+                    for (const Value& piece : pieces) env.appendToVar(static_cast<uint32_t>(in->a), piece.asString());
+                    VM_NEXT();
+                }
+
+                VM_OP(LoadElem) {
+                    int idx = static_cast<int>(stack.back().asNumber());
+                    stack.back() = env.getArrayElem(prog.names[static_cast<size_t>(in->a)], idx);
+                    VM_NEXT();
+                }
+
+                VM_OP(StoreElem) {
+                    Value v = vm_pop(stack);
+                    int idx = static_cast<int>(vm_pop(stack).asNumber());
+                    env.setArrayElem(prog.names[static_cast<size_t>(in->a)], idx, v);
+                    VM_NEXT();
+                }
+
+                VM_OP(BinOp) {
+                    Value rhs = vm_pop(stack);
+                    stack.back() = Parser::applyOp(stack.back(), static_cast<TokenKind>(in->a), rhs);
+                    VM_NEXT();
+                }
+
+                VM_OP(BinI) {
+                    Value rhs = vm_pop(stack);
+                    Value& lhs = stack.back();
+                    TokenKind op = static_cast<TokenKind>(in->a);
+                    if (lhs.isInt() && rhs.isInt()) lhs = Parser::intOp(op, lhs.p.i, rhs.p.i);
+                    else lhs = Parser::applyOp(lhs, op, rhs);
+                    VM_NEXT();
+                }
+
+                VM_OP(BinN) {
+                    Value rhs = vm_pop(stack);
+                    Value& lhs = stack.back();
+                    TokenKind op = static_cast<TokenKind>(in->a);
+                    bool num = (lhs.isDouble() && rhs.isNumber()) || (rhs.isDouble() && lhs.isNumber());
+                    if (num) lhs = Parser::numOp(op, lhs.asNumber(), rhs.asNumber());
+                    else lhs = Parser::applyOp(lhs, op, rhs);
+                    VM_NEXT();
+                }
+
+                VM_OP(Neg)
+                    stack.back() = Parser::negate(stack.back());
+                    VM_NEXT();
+
+                VM_OP(Not)
+                    stack.back() = Parser::logicalNot(stack.back());
+                    VM_NEXT();
+
+                VM_OP(Call) {
+                    // Arguments are read in place from the top of the stack.
+                    size_t argc = static_cast<size_t>(in->b);
+                    size_t base = stack.size() - argc;
+                    Value r = call_builtin(env, static_cast<uint8_t>(in->a), stack.data() + base, argc);
+                    stack.resize(base);
+                    stack.push_back(std::move(r));
+                    VM_NEXT();
+                }
+
+                VM_OP(Pop)
+                    stack.pop_back();
+                    VM_NEXT();
+
+                VM_OP(Print)
+                    basic_print_value(env, stack.back());
+                    stack.pop_back();
+                    VM_NEXT();
+
+                VM_OP(PrintLine)
+                    basic_print_value(env, stack.back());
+                    stack.pop_back();
+                    basic_print_char(env, '\n');
+                    VM_NEXT();
+
+                VM_OP(PrintTab)
+                    basic_print_tab_to_next_stop(env);
+                    VM_NEXT();
+
+                VM_OP(PrintChar)
+                    basic_print_char(env, static_cast<char>(in->a));
+                    VM_NEXT();
+
+                VM_OP(Jump)
+                    pc = static_cast<uint32_t>(in->a);
+                    if (takeBreak()) return Status::Break;
+                    VM_NEXT();
+
+                VM_OP(JumpIfFalse) {
+                    bool truthy = (stack.back().asNumber() != 0.0);
+                    stack.pop_back();
+                    if (!truthy) pc = static_cast<uint32_t>(in->a);
+                    VM_NEXT();
+                }
+
+                VM_OP(IfVarConst)
+                    if (!basic_if_var_const(env, static_cast<uint32_t>(in->a), static_cast<TokenKind>(in->flag),
+                                            prog.consts[static_cast<size_t>(in->b)])) {
+                        ++pc; // step over the GOTO to the end of the line
+                    }
+                    VM_NEXT();
+
+                VM_OP(Gosub)
+                    gosubStack.push_back({pc, false, 0});
+                    pc = static_cast<uint32_t>(in->a);
+                    VM_NEXT();
+
+                VM_OP(Return)
+                    pc = basic_return(env, gosubStack).returnPc;
+                    VM_NEXT();
+
+                VM_OP(ForInit) {
+                    double step = vm_pop(stack).asNumber();
+                    double end = vm_pop(stack).asNumber();
+                    double start = vm_pop(stack).asNumber();
+                    uint32_t var = static_cast<uint32_t>(in->a);
+                    Env::ForCounter counter = basic_for_start(env, var, start, end, step, in->flag != 0);
+                    basic_push_for(forStack, ForFrame{var, static_cast<uint32_t>(in->b), counter, pc});
+                    VM_NEXT();
+                }
+
+                VM_OP(Next)
+                    if (const ForFrame* frame = basic_next(env, forStack, static_cast<uint32_t>(in->b))) {
+                        pc = frame->resumePc;
+                        if (takeBreak()) return Status::Break;
+                        // The loop may go on in native code; it leaves pc where the VM continues.
+                        if (jit && jit->run(env, prog, *this, breakRequested) && takeBreak()) return Status::Break;
+                    }
+                    VM_NEXT();
+
+                VM_OP(End)
+                VM_OP(Halt)
+                    env.running = false;
+                    env.contAvailable = false;
+                    return Status::Ended;
+
+                VM_OP(Dim) {
+                    int ub = static_cast<int>(vm_pop(stack).asNumber());
+                    env.dimArray(prog.names[static_cast<size_t>(in->a)], ub);
+                    VM_NEXT();
+                }
+
+                VM_OP(Input) {
+                    const std::string& name = in->flag ? prog.names[static_cast<size_t>(in->a)]
+                                                      : env.varNames[static_cast<size_t>(in->a)];
+                    int idx = in->flag ? static_cast<int>(vm_pop(stack).asNumber()) : 0;
+                    std::string_view prompt;
+                    if (in->b >= 0) prompt = prog.consts[static_cast<size_t>(in->b)].asString();
+                    Value v = basic_input_value(env, prompt, name, Interpreter::basic_getline_with_sdl_pump);
+                    basic_assign(env, name, in->flag != 0, static_cast<uint32_t>(in->a), idx, v);
+                    VM_NEXT();
+                }
+
+                VM_OP(Read) {
+                    const std::string& name = in->flag ? prog.names[static_cast<size_t>(in->a)]
+                                                      : env.varNames[static_cast<size_t>(in->a)];
+                    int idx = in->flag ? static_cast<int>(vm_pop(stack).asNumber()) : 0;
+                    basic_assign(env, name, in->flag != 0, static_cast<uint32_t>(in->a), idx, basic_read_value(env, name));
+                    VM_NEXT();
+                }
+
+                VM_OP(Restore)
+                    env.restoreData(in->a, env.program);
+                    VM_NEXT();
+
+                VM_OP(Cls)
+                    basic_cls(env);
+                    VM_NEXT();
+
+                VM_OP(Locate) {
+                    int row = 1, col = 1, cursor = -1;
+                    if (in->flag & 4) cursor = static_cast<int>(vm_pop(stack).asNumber());
+                    if (in->flag & 2) col = static_cast<int>(vm_pop(stack).asNumber());
+                    if (in->flag & 1) row = static_cast<int>(vm_pop(stack).asNumber());
+                    basic_locate(env, row, col, cursor);
+                    VM_NEXT();
+                }
+
+                VM_OP(Color) {
+                    int fg = -1, bg = -1;
+                    if (in->flag & 2) bg = static_cast<int>(vm_pop(stack).asNumber());
+                    if (in->flag & 1) fg = static_cast<int>(vm_pop(stack).asNumber());
+                    basic_color(env, fg, bg);
+                    VM_NEXT();
+                }
+
+                VM_OP(Randomize) {
+                    double seed = in->flag ? vm_pop(stack).asNumber() : 0.0;
+                    basic_randomize(env, in->flag != 0, seed);
+                    VM_NEXT();
+                }
+
+                VM_OP(Beep)
+                    stack.resize(stack.size() - in->flag);
+                    basic_beep(env);
+                    VM_NEXT();
+
+                VM_OP(OnInterval)
+                    basic_on_interval(env, vm_pop(stack).asNumber(), in->a);
+                    VM_NEXT();
+
+                VM_OP(IntervalCtl)
+                    basic_interval_ctl(env, in->flag);
+                    VM_NEXT();
+
+                VM_OP(DefInt)
+                    env.setDefIntRange(static_cast<char>(in->a), static_cast<char>(in->b), true);
+                    VM_NEXT();
+
+                VM_OP(Clear) {
+                    if (in->flag) stack.pop_back();
+                    basic_clear(env); // FOR/GOSUB stacks live in the VM and are left untouched
+                    VM_NEXT();
+                }
+
+                VM_OP(Raise) {
+                    const std::string msg = prog.consts[static_cast<size_t>(in->a)].asString();
+                    if (in->flag) throw ParseError(msg);
+                    throw RuntimeError(msg);
+                }
+#if !BASIC_VM_THREADED
+            }
+        }
+#endif
+    } catch (const RuntimeError& e) {
+        std::cout << "Runtime error in " << prog.lineForPc(at) << ": " << e.what() << "\n";
+    } catch (const ParseError& e) {
+        std::cout << "Syntax error in " << prog.lineForPc(at) << ": " << e.what() << "\n";
+    }
+
+    // CONT retries the failing line from its start.
+    env.running = false;
+    env.contAvailable = true;
+    pc = prog.lineStartForPc(at);
+    stack.clear();
+    return Status::Error;
+}